@@ -301,6 +301,30 @@ BOOL WINAPI HeapSetInformation( HANDLE heap, HEAP_INFORMATION_CLASS infoclass, P
     return !ret;
 }
 
+BOOL WINAPI HeapSummary( HANDLE heap, DWORD flags, LPHEAP_SUMMARY summary )
+{
+    RTL_HEAP_USAGE usage;
+    NTSTATUS ret;
+
+    if (summary->cb != sizeof(*summary))
+    {
+        SetLastError( ERROR_INVALID_PARAMETER );
+        return FALSE;
+    }
+
+    usage.Length = sizeof(usage);
+    if ((ret = RtlUsageHeap( heap, flags, &usage )))
+    {
+        SetLastError( RtlNtStatusToDosError(ret) );
+        return FALSE;
+    }
+    summary->cbAllocated  = usage.BytesAllocated;
+    summary->cbCommitted  = usage.BytesCommitted;
+    summary->cbReserved   = usage.BytesReserved;
+    summary->cbMaxReserve = usage.BytesReservedMaximum;
+    return TRUE;
+}
+
 /*
  * Win32 Global heap functions (GlobalXXX).
  * These functions included in Win32 for compatibility with 16 bit Windows
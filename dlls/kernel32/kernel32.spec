@@ -931,7 +931,7 @@
 @ stub HeapSetFlags
 @ stdcall HeapSetInformation(ptr long ptr long)
 @ stdcall HeapSize(long long ptr) ntdll.RtlSizeHeap
-@ stub HeapSummary
+@ stdcall HeapSummary(long long ptr)
 @ stdcall HeapUnlock(long)
 @ stub HeapUsage
 @ stdcall HeapValidate(long long ptr)
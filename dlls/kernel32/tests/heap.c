@@ -39,6 +39,8 @@
 #define HEAP_VALIDATE_PARAMS  0x40000000
 
 static BOOL (WINAPI *pHeapQueryInformation)(HANDLE, HEAP_INFORMATION_CLASS, PVOID, SIZE_T, PSIZE_T);
+static BOOL (WINAPI *pHeapSetInformation)(HANDLE, HEAP_INFORMATION_CLASS, PVOID, SIZE_T);
+static BOOL (WINAPI *pHeapSummary)(HANDLE, DWORD, LPHEAP_SUMMARY);
 static BOOL (WINAPI *pGetPhysicallyInstalledSystemMemory)(ULONGLONG *);
 static ULONG (WINAPI *pRtlGetNtGlobalFlags)(void);
 
@@ -892,6 +894,69 @@ static void test_HeapQueryInformation(void)
     ok(info == 0 || info == 1 || info == 2, "expected 0, 1 or 2, got %u\n", info);
 }
 
+static void test_HeapSetInformation(void)
+{
+    void *ptr[64];
+    HANDLE heap;
+    ULONG info;
+    SIZE_T size;
+    BOOL ret;
+    int i;
+
+    pHeapSetInformation = (void *)GetProcAddress(GetModuleHandleA("kernel32.dll"), "HeapSetInformation");
+    if (!pHeapSetInformation || !pHeapQueryInformation)
+    {
+        win_skip("HeapSetInformation is not available\n");
+        return;
+    }
+
+    heap = HeapCreate(0, 0, 0);
+    ok(heap != NULL, "HeapCreate error %u\n", GetLastError());
+
+    info = 2;
+    ret = pHeapSetInformation(heap, HeapCompatibilityInformation, &info, sizeof(info));
+    ok(ret, "HeapSetInformation error %u\n", GetLastError());
+
+    info = 0xdeadbeef;
+    ret = pHeapQueryInformation(heap, HeapCompatibilityInformation, &info, sizeof(info), NULL);
+    ok(ret, "HeapQueryInformation error %u\n", GetLastError());
+    ok(info == 2, "expected 2, got %u\n", info);
+
+    /* freed blocks are recycled, make sure they are still sized and validated correctly */
+    for (i = 0; i < 2 * ARRAY_SIZE(ptr); i++)
+    {
+        SIZE_T alloc_size = 1 + (i * 37) % 1000;
+        int j = i % ARRAY_SIZE(ptr);
+
+        if (i >= ARRAY_SIZE(ptr))
+        {
+            ret = HeapFree(heap, 0, ptr[j]);
+            ok(ret, "HeapFree error %u\n", GetLastError());
+        }
+        ptr[j] = HeapAlloc(heap, HEAP_ZERO_MEMORY, alloc_size);
+        ok(ptr[j] != NULL, "HeapAlloc failed for size %lu\n", alloc_size);
+        size = HeapSize(heap, 0, ptr[j]);
+        ok(size == alloc_size, "expected size %lu, got %lu\n", alloc_size, size);
+        ok(!((BYTE *)ptr[j])[0] && !((BYTE *)ptr[j])[alloc_size - 1], "block not zeroed\n");
+    }
+    ok(HeapValidate(heap, 0, NULL), "HeapValidate failed\n");
+    for (i = 0; i < ARRAY_SIZE(ptr); i += 2) HeapFree(heap, 0, ptr[i]);
+    ok(HeapValidate(heap, 0, NULL), "HeapValidate failed\n");
+    HeapDestroy(heap);
+
+    /* the low-fragmentation heap requires serialization */
+    heap = HeapCreate(HEAP_NO_SERIALIZE, 0, 0);
+    ok(heap != NULL, "HeapCreate error %u\n", GetLastError());
+    info = 2;
+    ret = pHeapSetInformation(heap, HeapCompatibilityInformation, &info, sizeof(info));
+    ok(!ret, "HeapSetInformation should fail\n");
+    info = 0xdeadbeef;
+    ret = pHeapQueryInformation(heap, HeapCompatibilityInformation, &info, sizeof(info), NULL);
+    ok(ret, "HeapQueryInformation error %u\n", GetLastError());
+    ok(info == 0, "expected 0, got %u\n", info);
+    HeapDestroy(heap);
+}
+
 static void test_heap_checks( DWORD flags )
 {
     BYTE old, *p, *p2;
@@ -1184,6 +1249,45 @@ static void test_child_heap( const char *arg )
     test_heap_checks( expect_heap );
 }
 
+static void test_HeapSummary(void)
+{
+    HEAP_SUMMARY summary;
+    HANDLE heap;
+    void *ptr;
+    BOOL ret;
+
+    pHeapSummary = (void *)GetProcAddress(GetModuleHandleA("kernel32.dll"), "HeapSummary");
+    if (!pHeapSummary)
+    {
+        win_skip("HeapSummary is not available\n");
+        return;
+    }
+
+    heap = HeapCreate(0, 0, 0);
+    ok(heap != NULL, "HeapCreate error %u\n", GetLastError());
+
+    memset(&summary, 0, sizeof(summary));
+    SetLastError(0xdeadbeef);
+    ret = pHeapSummary(heap, 0, &summary);
+    ok(!ret, "HeapSummary succeeded\n");
+    ok(GetLastError() == ERROR_INVALID_PARAMETER, "got error %u\n", GetLastError());
+
+    ptr = HeapAlloc(heap, 0, 0x1000);
+    ok(ptr != NULL, "HeapAlloc failed\n");
+
+    summary.cb = sizeof(summary);
+    ret = pHeapSummary(heap, 0, &summary);
+    ok(ret, "HeapSummary error %u\n", GetLastError());
+    ok(summary.cbAllocated >= 0x1000, "got cbAllocated %lu\n", summary.cbAllocated);
+    ok(summary.cbCommitted >= summary.cbAllocated, "got cbCommitted %lu, cbAllocated %lu\n",
+       summary.cbCommitted, summary.cbAllocated);
+    ok(summary.cbReserved >= summary.cbCommitted, "got cbReserved %lu, cbCommitted %lu\n",
+       summary.cbReserved, summary.cbCommitted);
+
+    HeapFree(heap, 0, ptr);
+    HeapDestroy(heap);
+}
+
 static void test_GetPhysicallyInstalledSystemMemory(void)
 {
     HMODULE kernel32 = GetModuleHandleA("kernel32.dll");
@@ -1245,6 +1349,8 @@ START_TEST(heap)
     test_sized_HeapReAlloc((1 << 20), 1);
 
     test_HeapQueryInformation();
+    test_HeapSetInformation();
+    test_HeapSummary();
     test_GetPhysicallyInstalledSystemMemory();
 
     if (pRtlGetNtGlobalFlags)
@@ -781,7 +781,7 @@
 @ stdcall HeapReAlloc(long long ptr long) kernel32.HeapReAlloc
 @ stdcall HeapSetInformation(ptr long ptr long) kernel32.HeapSetInformation
 @ stdcall HeapSize(long long ptr) kernel32.HeapSize
-@ stub HeapSummary
+@ stdcall HeapSummary(long long ptr) kernel32.HeapSummary
 @ stdcall HeapUnlock(long) kernel32.HeapUnlock
 @ stdcall HeapValidate(long long ptr) kernel32.HeapValidate
 @ stdcall HeapWalk(long ptr) kernel32.HeapWalk
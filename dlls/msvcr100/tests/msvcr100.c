@@ -170,8 +170,8 @@ struct SchedulerVtbl {
     unsigned int (__thiscall *Release)(Scheduler*);
     void (__thiscall *RegisterShutdownEvent)(Scheduler*,HANDLE);
     void (__thiscall *Attach)(Scheduler*);
-    /* CreateScheduleGroup */
-    /* ScheduleTask */
+    void* (__thiscall *CreateScheduleGroup)(Scheduler*);
+    void (__thiscall *ScheduleTask)(Scheduler*,void (__cdecl*)(void*),void*);
 };
 
 static int* (__cdecl *p_errno)(void);
@@ -956,8 +956,24 @@ static void test_ExternalContextBase(void)
     CloseHandle(thread);
 }
 
+struct scheduled_task_data
+{
+    HANDLE event;
+    Scheduler *scheduler;
+};
+
+static void __cdecl scheduled_task(void *arg)
+{
+    struct scheduled_task_data *data = arg;
+
+    data->scheduler = p_CurrentScheduler_Get();
+    SetEvent(data->event);
+}
+
 static void test_Scheduler(void)
 {
+    struct scheduled_task_data task_data;
+    DWORD ret;
     Scheduler *scheduler, *current_scheduler;
     SchedulerPolicy policy;
     unsigned int i;
@@ -985,6 +1001,15 @@ static void test_Scheduler(void)
 
     i = call_func1(scheduler->vtable->GetNumberOfVirtualProcessors, scheduler);
     ok(i == 1, "Scheduler::GetNumberOfVirtualProcessors() = %u\n", i);
+
+    task_data.event = CreateEventW(NULL, FALSE, FALSE, NULL);
+    task_data.scheduler = NULL;
+    call_func3(scheduler->vtable->ScheduleTask, scheduler, scheduled_task, &task_data);
+    ret = WaitForSingleObject(task_data.event, 5000);
+    ok(ret == WAIT_OBJECT_0, "WaitForSingleObject returned %u\n", ret);
+    ok(task_data.scheduler == scheduler, "task ran on scheduler %p, expected %p\n",
+            task_data.scheduler, scheduler);
+    CloseHandle(task_data.event);
     call_func1(scheduler->vtable->Release, scheduler);
     call_func1(p_SchedulerPolicy_dtor, &policy);
 }
@@ -35,6 +35,7 @@ WINE_DEFAULT_DEBUG_CHANNEL(msvcrt);
 
 static int context_id = -1;
 static int scheduler_id = -1;
+static HANDLE keyed_event;
 
 #ifdef __i386__
 
@@ -115,6 +116,7 @@ typedef struct {
     struct scheduler_list scheduler;
     unsigned int id;
     union allocator_cache_entry *allocator_cache[8];
+    LONG blocked;
 } ExternalContextBase;
 extern const vtable_ptr MSVCRT_ExternalContextBase_vtable;
 static void ExternalContextBase_ctor(ExternalContextBase*);
@@ -156,6 +158,7 @@ typedef struct {
     int shutdown_size;
     HANDLE *shutdown_events;
     CRITICAL_SECTION cs;
+    PTP_POOL pool;
 } ThreadScheduler;
 extern const vtable_ptr MSVCRT_ThreadScheduler_vtable;
 
@@ -167,6 +170,12 @@ typedef struct {
     char empty;
 } _CurrentScheduler;
 
+struct scheduled_task {
+    ThreadScheduler *scheduler;
+    void (__cdecl *proc)(void*);
+    void *data;
+};
+
 static int context_tls_index = TLS_OUT_OF_INDEXES;
 
 static CRITICAL_SECTION default_scheduler_cs;
@@ -181,6 +190,7 @@ static SchedulerPolicy default_scheduler_policy;
 static ThreadScheduler *default_scheduler;
 
 static void create_default_scheduler(void);
+void __cdecl CurrentScheduler_Detach(void);
 
 static Context* try_get_current_context(void)
 {
@@ -256,22 +266,47 @@ unsigned int __cdecl Context_Id(void)
     return ctx ? call_Context_GetId(ctx) : -1;
 }
 
+static void init_keyed_event(void)
+{
+    if(!keyed_event) {
+        HANDLE event;
+
+        NtCreateKeyedEvent(&event, GENERIC_READ|GENERIC_WRITE, NULL, 0);
+        if(InterlockedCompareExchangePointer(&keyed_event, event, NULL) != NULL)
+            NtClose(event);
+    }
+}
+
 /* ?Block@Context@Concurrency@@SAXXZ */
 void __cdecl Context_Block(void)
 {
-    FIXME("()\n");
+    ExternalContextBase *context = (ExternalContextBase*)get_current_context();
+
+    TRACE("()\n");
+
+    if(context->context.vtable != &MSVCRT_ExternalContextBase_vtable) {
+        ERR("unknown context set\n");
+        return;
+    }
+
+    /* an Unblock issued before the Block makes it return immediately */
+    init_keyed_event();
+    if(InterlockedIncrement(&context->blocked) == 1)
+        NtWaitForKeyedEvent(keyed_event, &context->blocked, 0, NULL);
 }
 
 /* ?Yield@Context@Concurrency@@SAXXZ */
 void __cdecl Context_Yield(void)
 {
-    FIXME("()\n");
+    TRACE("()\n");
+    SwitchToThread();
 }
 
 /* ?_SpinYield@Context@Concurrency@@SAXXZ */
 void __cdecl Context__SpinYield(void)
 {
-    FIXME("()\n");
+    TRACE("()\n");
+    SwitchToThread();
 }
 
 /* ?IsCurrentTaskCollectionCanceling@Context@Concurrency@@SA_NXZ */
@@ -327,14 +362,23 @@ unsigned int __thiscall ExternalContextBase_GetScheduleGroupId(const ExternalCon
 DEFINE_THISCALL_WRAPPER(ExternalContextBase_Unblock, 4)
 void __thiscall ExternalContextBase_Unblock(ExternalContextBase *this)
 {
-    FIXME("(%p)->() stub\n", this);
+    LONG blocked;
+
+    TRACE("(%p)->()\n", this);
+
+    init_keyed_event();
+    blocked = InterlockedDecrement(&this->blocked);
+    if(!blocked)
+        NtReleaseKeyedEvent(keyed_event, &this->blocked, 0, NULL);
+    else if(blocked < -1)
+        WARN("(%p) unbalanced unblock\n", this);
 }
 
 DEFINE_THISCALL_WRAPPER(ExternalContextBase_IsSynchronouslyBlocked, 4)
 MSVCRT_bool __thiscall ExternalContextBase_IsSynchronouslyBlocked(const ExternalContextBase *this)
 {
-    FIXME("(%p)->() stub\n", this);
-    return FALSE;
+    TRACE("(%p)->()\n", this);
+    return this->blocked > 0;
 }
 
 static void ExternalContextBase_dtor(ExternalContextBase *this)
@@ -634,6 +678,9 @@ static void ThreadScheduler_dtor(ThreadScheduler *this)
         SetEvent(this->shutdown_events[i]);
     MSVCRT_operator_delete(this->shutdown_events);
 
+    if(this->pool)
+        CloseThreadpool(this->pool);
+
     this->cs.DebugInfo->Spare[0] = 0;
     DeleteCriticalSection(&this->cs);
 }
@@ -742,18 +789,99 @@ DEFINE_THISCALL_WRAPPER(ThreadScheduler_CreateScheduleGroup, 4)
     return NULL;
 }
 
+static void WINAPI destroy_scheduler_proc(PTP_CALLBACK_INSTANCE instance, void *arg)
+{
+    ThreadScheduler *scheduler = arg;
+
+    ThreadScheduler_dtor(scheduler);
+    MSVCRT_operator_delete(scheduler);
+}
+
+static void WINAPI scheduled_task_proc(PTP_CALLBACK_INSTANCE instance, void *arg)
+{
+    struct scheduled_task task = *(struct scheduled_task*)arg;
+    ExternalContextBase *context = (ExternalContextBase*)get_current_context();
+    BOOL attached = FALSE;
+
+    MSVCRT_operator_delete(arg);
+
+    /* run the task with its scheduler as the current one */
+    if(context->context.vtable == &MSVCRT_ExternalContextBase_vtable &&
+            context->scheduler.scheduler != &task.scheduler->scheduler) {
+        ThreadScheduler_Attach(task.scheduler);
+        attached = TRUE;
+    }
+
+    task.proc(task.data);
+
+    if(attached)
+        CurrentScheduler_Detach();
+
+    /* a task can't close the pool it runs in, destroy the scheduler from the default pool */
+    if(!InterlockedDecrement(&task.scheduler->ref) &&
+            !TrySubmitThreadpoolCallback(destroy_scheduler_proc, task.scheduler, NULL)) {
+        ERR("can't destroy scheduler %p outside of its pool\n", task.scheduler);
+        destroy_scheduler_proc(instance, task.scheduler);
+    }
+}
+
+static PTP_POOL get_scheduler_pool(ThreadScheduler *this)
+{
+    PTP_POOL pool;
+
+    if(this->pool)
+        return this->pool;
+
+    EnterCriticalSection(&this->cs);
+    if(!this->pool && (pool = CreateThreadpool(NULL))) {
+        unsigned int min_concurrency = SchedulerPolicy_GetPolicyValue(&this->policy, MinConcurrency);
+
+        /* tasks may block waiting for other tasks, so the number of threads
+         * isn't limited to the number of virtual processors */
+        SetThreadpoolThreadMinimum(pool, min(min_concurrency, this->virt_proc_no));
+        this->pool = pool;
+    }
+    LeaveCriticalSection(&this->cs);
+    return this->pool;
+}
+
 DEFINE_THISCALL_WRAPPER(ThreadScheduler_ScheduleTask_loc, 16)
 void __thiscall ThreadScheduler_ScheduleTask_loc(ThreadScheduler *this,
         void (__cdecl *proc)(void*), void* data, /*location*/void *placement)
 {
-    FIXME("(%p %p %p %p) stub\n", this, proc, data, placement);
+    TP_CALLBACK_ENVIRON env;
+    struct scheduled_task *task;
+
+    TRACE("(%p %p %p %p)\n", this, proc, data, placement);
+
+    memset(&env, 0, sizeof(env));
+    env.Version = 1;
+    if(!(env.Pool = get_scheduler_pool(this)))
+        throw_exception(EXCEPTION_SCHEDULER_RESOURCE_ALLOCATION_ERROR,
+                HRESULT_FROM_WIN32(GetLastError()), NULL);
+
+    task = MSVCRT_operator_new(sizeof(*task));
+    task->scheduler = this;
+    task->proc = proc;
+    task->data = data;
+    ThreadScheduler_Reference(this);
+
+    if(!TrySubmitThreadpoolCallback(scheduled_task_proc, task, &env)) {
+        DWORD err = GetLastError();
+
+        ThreadScheduler_Release(this);
+        MSVCRT_operator_delete(task);
+        throw_exception(EXCEPTION_SCHEDULER_RESOURCE_ALLOCATION_ERROR,
+                HRESULT_FROM_WIN32(err), NULL);
+    }
 }
 
 DEFINE_THISCALL_WRAPPER(ThreadScheduler_ScheduleTask, 12)
 void __thiscall ThreadScheduler_ScheduleTask(ThreadScheduler *this,
         void (__cdecl *proc)(void*), void* data)
 {
-    FIXME("(%p %p %p) stub\n", this, proc, data);
+    TRACE("(%p %p %p)\n", this, proc, data);
+    ThreadScheduler_ScheduleTask_loc(this, proc, data, NULL);
 }
 
 DEFINE_THISCALL_WRAPPER(ThreadScheduler_IsAvailableLocation, 8)
@@ -803,6 +931,7 @@ static ThreadScheduler* ThreadScheduler_ctor(ThreadScheduler *this,
 
     this->shutdown_count = this->shutdown_size = 0;
     this->shutdown_events = NULL;
+    this->pool = NULL;
 
     InitializeCriticalSection(&this->cs);
     this->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": ThreadScheduler");
@@ -1150,6 +1279,8 @@ void msvcrt_free_scheduler(void)
         ThreadScheduler_dtor(default_scheduler);
         MSVCRT_operator_delete(default_scheduler);
     }
+    if(keyed_event)
+        NtClose(keyed_event);
 }
 
 void msvcrt_free_scheduler_thread(void)
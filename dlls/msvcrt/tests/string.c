@@ -101,6 +101,8 @@ static int (__cdecl *p__mbccpy_s)(unsigned char*, size_t, int*, const unsigned c
 static int (__cdecl *p__memicmp)(const char*, const char*, size_t);
 static int (__cdecl *p__memicmp_l)(const char*, const char*, size_t, _locale_t);
 static size_t (__cdecl *p___strncnt)(const char*, size_t);
+static size_t (__cdecl *p_wcslen)(const wchar_t*);
+static wchar_t* (__cdecl *p_wcschr)(const wchar_t*, wchar_t);
 
 #define SETNOFAIL(x,y) x = (void*)GetProcAddress(hMsvcrt,y)
 #define SET(x,y) SETNOFAIL(x,y); ok(x != NULL, "Export '%s' not found\n", y)
@@ -3603,6 +3605,26 @@ static void test___strncnt(void)
     }
 }
 
+static void test_wcslen_wcschr(void)
+{
+    static const wchar_t abcW[] = {'a','b','c','d','e','f','g','h','i','j',0};
+    wchar_t buffer[16];
+    int offset;
+
+    /* the scanning itself is tested in ntdll, only check the exports here */
+    for (offset = 0; offset < 4; offset++)
+    {
+        wchar_t *str = buffer + offset;
+
+        memcpy(str, abcW, sizeof(abcW));
+        ok(p_wcslen(str) == 10, "offset %d: got length %d\n", offset, (int)p_wcslen(str));
+        ok(p_wcschr(str, 'h') == str + 7, "offset %d: got %p, expected %p\n",
+           offset, p_wcschr(str, 'h'), str + 7);
+        ok(p_wcschr(str, 0) == str + 10, "offset %d: wrong terminator\n", offset);
+        ok(p_wcschr(str, 'z') == NULL, "offset %d: unexpected match\n", offset);
+    }
+}
+
 START_TEST(string)
 {
     char mem[100];
@@ -3662,6 +3684,8 @@ START_TEST(string)
     p__memicmp = (void*)GetProcAddress(hMsvcrt, "_memicmp");
     p__memicmp_l = (void*)GetProcAddress(hMsvcrt, "_memicmp_l");
     p___strncnt = (void*)GetProcAddress(hMsvcrt, "__strncnt");
+    p_wcslen = (void*)GetProcAddress(hMsvcrt, "wcslen");
+    p_wcschr = (void*)GetProcAddress(hMsvcrt, "wcschr");
 
     /* MSVCRT memcpy behaves like memmove for overlapping moves,
        MFC42 CString::Insert seems to rely on that behaviour */
@@ -3730,4 +3754,5 @@ START_TEST(string)
     test__tcsncoll();
     test__tcsnicoll();
     test___strncnt();
+    test_wcslen_wcschr();
 }
@@ -2505,14 +2505,6 @@ int CDECL MSVCRT_towlower(MSVCRT_wint_t c)
     return MSVCRT__towlower_l(c, NULL);
 }
 
-/*********************************************************************
- *              wcschr (MSVCRT.@)
- */
-MSVCRT_wchar_t* CDECL MSVCRT_wcschr(const MSVCRT_wchar_t *str, MSVCRT_wchar_t ch)
-{
-    return strchrW(str, ch);
-}
-
 /*********************************************************************
  *              wcsrchr (MSVCRT.@)
  */
@@ -2521,14 +2513,6 @@ MSVCRT_wchar_t* CDECL MSVCRT_wcsrchr(const MSVCRT_wchar_t *str, MSVCRT_wchar_t c
     return strrchrW(str, ch);
 }
 
-/***********************************************************************
- *              wcslen (MSVCRT.@)
- */
-int CDECL MSVCRT_wcslen(const MSVCRT_wchar_t *str)
-{
-    return strlenW(str);
-}
-
 /*********************************************************************
  *              wcsstr (MSVCRT.@)
  */
@@ -64,17 +64,17 @@ static inline void small_pause(void)
 static int wait_op = 128; /*FUTEX_WAIT|FUTEX_PRIVATE_FLAG*/
 static int wake_op = 129; /*FUTEX_WAKE|FUTEX_PRIVATE_FLAG*/
 
-static inline int futex_wait( int *addr, int val, struct timespec *timeout )
+int futex_wait( const int *addr, int val, struct timespec *timeout )
 {
     return syscall( __NR_futex, addr, wait_op, val, timeout, 0, 0 );
 }
 
-static inline int futex_wake( int *addr, int val )
+int futex_wake( const int *addr, int val )
 {
     return syscall( __NR_futex, addr, wake_op, val, NULL, 0, 0 );
 }
 
-static inline int use_futexes(void)
+int use_futexes(void)
 {
     static int supported = -1;
 
@@ -50,6 +50,9 @@ static void dump_DEBUG_HEAP_INFORMATION(const DEBUG_HEAP_INFORMATION *iBuf)
   if (NULL == iBuf) return ;
   TRACE( "Base:%d\n", iBuf->Base );
   TRACE( "Flags:%d\n", iBuf->Flags );
+  TRACE( "Allocated:%u\n", iBuf->Allocated );
+  TRACE( "Committed:%u\n", iBuf->Committed );
+  TRACE( "BlockCount:%u\n", iBuf->BlockCount );
 }
 
 static void dump_DEBUG_LOCK_INFORMATION(const DEBUG_LOCK_INFORMATION *iBuf)
@@ -128,7 +131,7 @@ NTSTATUS WINAPI RtlQueryProcessDebugInformation(IN ULONG iProcessId, IN ULONG iD
    }
    if (iDebugInfoMask & PDI_HEAPS) {
      PDEBUG_HEAP_INFORMATION info = RtlAllocateHeap(GetProcessHeap(), 0, sizeof(DEBUG_HEAP_INFORMATION));
-     memset(info, 0, sizeof(DEBUG_HEAP_INFORMATION));
+     heap_get_debug_info(GetProcessHeap(), info);
      if (iDebugInfoMask & PDI_HEAP_TAGS) {
      }
      if (iDebugInfoMask & PDI_HEAP_BLOCKS) {
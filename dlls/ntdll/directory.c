@@ -178,7 +178,7 @@ struct dir_data_buffer
 struct dir_data_names
 {
     const WCHAR *long_name;          /* long file name in Unicode */
-    const WCHAR *short_name;         /* short file name in Unicode */
+    const WCHAR *short_name;         /* short file name in Unicode, NULL if generated on demand */
     const char  *unix_name;          /* Unix file name in host encoding */
 };
 
@@ -355,7 +355,8 @@ static BOOL add_dir_data_names( struct dir_data *data, const WCHAR *long_name,
         data->names = names;
     }
 
-    if (short_name[0])
+    if (!short_name) names[data->count].short_name = NULL;
+    else if (short_name[0])
     {
         if (!(names[data->count].short_name = add_dir_data_nameW( data, short_name ))) return FALSE;
     }
@@ -1431,10 +1432,33 @@ static BOOLEAN match_filename( const UNICODE_STRING *name_str, const UNICODE_STR
 }
 
 
+/***********************************************************************
+ *           get_short_file_name
+ *
+ * Generate the short name of a file if it is not a valid DOS name itself.
+ * 'buffer' must be at least 12 characters long.
+ * Returns length of short name in chars, 0 if the file doesn't have one.
+ */
+static ULONG get_short_file_name( const WCHAR *long_name, ULONG long_len, WCHAR *buffer )
+{
+    UNICODE_STRING str;
+    BOOLEAN spaces;
+
+    str.Buffer = (WCHAR *)long_name;
+    str.Length = long_len * sizeof(WCHAR);
+    str.MaximumLength = str.Length;
+    if (RtlIsNameLegalDOS8Dot3( &str, NULL, &spaces ) && !spaces) return 0;
+    return hash_short_file_name( &str, buffer );
+}
+
+
 /***********************************************************************
  *           append_entry
  *
  * Add a file to the directory data if it matches the mask.
+ * Hashed short names are only generated here when needed to match the mask;
+ * otherwise they are left for get_dir_data_entry to generate if the
+ * information class requires them.
  */
 static BOOL append_entry( struct dir_data *data, const char *long_name,
                           const char *short_name, const UNICODE_STRING *mask )
@@ -1459,28 +1483,23 @@ static BOOL append_entry( struct dir_data *data, const char *long_name,
         if (short_len == -1) short_len = ARRAY_SIZE( short_nameW ) - 1;
         for (i = 0; i < short_len; i++) short_nameW[i] = toupperW( short_nameW[i] );
     }
-    else  /* generate a short name if necessary */
-    {
-        BOOLEAN spaces;
-
-        short_len = 0;
-        if (!RtlIsNameLegalDOS8Dot3( &str, NULL, &spaces ) || spaces)
-            short_len = hash_short_file_name( &str, short_nameW );
-    }
-    short_nameW[short_len] = 0;
+    else short_len = -1;  /* generated on demand */
 
     TRACE( "long %s short %s mask %s\n",
-           debugstr_w( long_nameW ), debugstr_w( short_nameW ), debugstr_us( mask ));
+           debugstr_w( long_nameW ), debugstr_a( short_name ), debugstr_us( mask ));
 
     if (mask && !match_filename( &str, mask ))
     {
+        if (short_len == -1) short_len = get_short_file_name( long_nameW, long_len, short_nameW );
         if (!short_len) return TRUE;  /* no short name to match */
         str.Buffer = short_nameW;
         str.Length = short_len * sizeof(WCHAR);
         str.MaximumLength = sizeof(short_nameW);
         if (!match_filename( &str, mask )) return TRUE;
     }
+    if (!short_name) return add_dir_data_names( data, long_nameW, NULL, long_name );
 
+    short_nameW[short_len] = 0;
     return add_dir_data_names( data, long_nameW, short_nameW, long_name );
 }
 
@@ -1497,7 +1516,8 @@ static NTSTATUS get_dir_data_entry( struct dir_data *dir_data, void *info_ptr, I
     const struct dir_data_names *names = &dir_data->names[dir_data->pos];
     union file_directory_info *info;
     struct stat st;
-    ULONG name_len, start, dir_size, attributes;
+    ULONG name_len, short_len = 0, start, dir_size, attributes;
+    WCHAR short_nameW[12];
 
     if (get_file_info( names->unix_name, &st, &attributes ) == -1)
     {
@@ -1514,7 +1534,18 @@ static NTSTATUS get_dir_data_entry( struct dir_data *dir_data, void *info_ptr, I
     if (start + dir_size > max_length) return STATUS_MORE_ENTRIES;
 
     max_length -= start + dir_size;
-    name_len = strlenW( names->long_name ) * sizeof(WCHAR);
+    name_len = strlenW( names->long_name );
+    if (class == FileBothDirectoryInformation || class == FileIdBothDirectoryInformation)
+    {
+        if (names->short_name)
+        {
+            short_len = strlenW( names->short_name );
+            memcpy( short_nameW, names->short_name, short_len * sizeof(WCHAR) );
+        }
+        else short_len = get_short_file_name( names->long_name, name_len, short_nameW );
+        short_len *= sizeof(WCHAR);
+    }
+    name_len *= sizeof(WCHAR);
     /* if this is not the first entry, fail; the first entry is always returned (but truncated) */
     if (*last_info && name_len > max_length) return STATUS_MORE_ENTRIES;
 
@@ -1552,15 +1583,15 @@ static NTSTATUS get_dir_data_entry( struct dir_data *dir_data, void *info_ptr, I
 
     case FileBothDirectoryInformation:
         info->both.EaSize = 0; /* FIXME */
-        info->both.ShortNameLength = strlenW( names->short_name ) * sizeof(WCHAR);
-        memcpy( info->both.ShortName, names->short_name, info->both.ShortNameLength );
+        info->both.ShortNameLength = short_len;
+        memcpy( info->both.ShortName, short_nameW, short_len );
         info->both.FileNameLength = name_len;
         break;
 
     case FileIdBothDirectoryInformation:
         info->id_both.EaSize = 0; /* FIXME */
-        info->id_both.ShortNameLength = strlenW( names->short_name ) * sizeof(WCHAR);
-        memcpy( info->id_both.ShortName, names->short_name, info->id_both.ShortNameLength );
+        info->id_both.ShortNameLength = short_len;
+        memcpy( info->id_both.ShortName, short_nameW, short_len );
         info->id_both.FileNameLength = name_len;
         break;
 
@@ -1863,8 +1894,9 @@ static NTSTATUS init_cached_dir_data( struct dir_data **data_ret, int fd, const
     }
 
     TRACE( "mask %s found %u files\n", debugstr_us( mask ), data->count );
-    for (i = 0; i < data->count; i++)
-        TRACE( "%s %s\n", debugstr_w(data->names[i].long_name), debugstr_w(data->names[i].short_name) );
+    if (TRACE_ON(file))
+        for (i = 0; i < data->count; i++)
+            TRACE( "%s %s\n", debugstr_w(data->names[i].long_name), debugstr_w(data->names[i].short_name) );
 
     *data_ret = data;
     return data->count ? STATUS_SUCCESS : STATUS_NO_SUCH_FILE;
@@ -2024,6 +2056,249 @@ NTSTATUS WINAPI NtQueryDirectoryFile( HANDLE handle, HANDLE event,
 }
 
 
+/* case-insensitive name index of a directory, used to avoid repeated readdir scans */
+struct dir_lookup_name
+{
+    struct dir_lookup_name *next;       /* next name in the hash bucket */
+    unsigned int            hash;       /* hash of the case-folded name */
+    unsigned short          len;        /* length of the case-folded name in chars */
+    BOOLEAN                 is_short;   /* name is a hashed DOS short name */
+    const WCHAR            *name;       /* case-folded Windows name */
+    char                    unix_name[1];
+};
+
+struct dir_lookup_cache
+{
+    struct list             entry;      /* entry in the most recently used list */
+    struct file_identity    id;         /* directory file identity */
+    time_t                  mtime;      /* directory modification time when the index was built */
+    unsigned long           mtime_nsec;
+    unsigned int            nb_buckets; /* number of hash buckets, a power of 2 */
+    struct dir_lookup_name *buckets[1];
+};
+
+#define MAX_DIR_LOOKUP_CACHES 16
+
+static struct list dir_lookup_caches = LIST_INIT( dir_lookup_caches );
+static unsigned int dir_lookup_cache_count;
+
+static RTL_CRITICAL_SECTION dir_lookup_section;
+static RTL_CRITICAL_SECTION_DEBUG dir_lookup_section_debug =
+{
+    0, 0, &dir_lookup_section,
+    { &dir_lookup_section_debug.ProcessLocksList, &dir_lookup_section_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": dir_lookup_section") }
+};
+static RTL_CRITICAL_SECTION dir_lookup_section = { &dir_lookup_section_debug, -1, 0, 0, 0, 0 };
+
+static inline unsigned long get_mtime_nsec( const struct stat *st )
+{
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+    return st->st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+    return st->st_mtimespec.tv_nsec;
+#else
+    return 0;
+#endif
+}
+
+/* hash a name that has already been case-folded */
+static unsigned int hash_dir_lookup_name( const WCHAR *name, unsigned int len )
+{
+    unsigned int i, hash = 0;
+
+    for (i = 0; i < len; i++) hash = hash * 31 + name[i];
+    return hash;
+}
+
+static struct dir_lookup_name *alloc_dir_lookup_name( const char *unix_name, const WCHAR *name,
+                                                      unsigned int len, BOOLEAN is_short )
+{
+    struct dir_lookup_name *entry;
+    size_t unix_len = strlen( unix_name ) + 1;
+    size_t name_offset = (offsetof( struct dir_lookup_name, unix_name[unix_len] ) + sizeof(WCHAR) - 1)
+                         & ~(sizeof(WCHAR) - 1);
+    WCHAR *ptr;
+    unsigned int i;
+
+    if (!(entry = RtlAllocateHeap( GetProcessHeap(), 0, name_offset + len * sizeof(WCHAR) )))
+        return NULL;
+    ptr = (WCHAR *)((char *)entry + name_offset);
+    for (i = 0; i < len; i++) ptr[i] = tolowerW( name[i] );
+    memcpy( entry->unix_name, unix_name, unix_len );
+    entry->name     = ptr;
+    entry->len      = len;
+    entry->is_short = is_short;
+    entry->hash     = hash_dir_lookup_name( ptr, len );
+    return entry;
+}
+
+static void free_dir_lookup_names( struct dir_lookup_name *entry )
+{
+    struct dir_lookup_name *next;
+
+    for ( ; entry; entry = next)
+    {
+        next = entry->next;
+        RtlFreeHeap( GetProcessHeap(), 0, entry );
+    }
+}
+
+static void free_dir_lookup_cache( struct dir_lookup_cache *cache )
+{
+    unsigned int i;
+
+    list_remove( &cache->entry );
+    dir_lookup_cache_count--;
+    for (i = 0; i < cache->nb_buckets; i++) free_dir_lookup_names( cache->buckets[i] );
+    RtlFreeHeap( GetProcessHeap(), 0, cache );
+}
+
+/***********************************************************************
+ *           create_dir_lookup_cache
+ *
+ * Build the case-folded name index of a directory, including the hashed
+ * short names of entries that are not valid 8.3 names.
+ * dir_lookup_section must be held by caller.
+ */
+static struct dir_lookup_cache *create_dir_lookup_cache( const char *unix_name, const struct stat *st )
+{
+    WCHAR buffer[MAX_DIR_ENTRY_LEN], short_nameW[12];
+    struct dir_lookup_name *names = NULL, *entry, *next;
+    struct dir_lookup_cache *cache;
+    struct dirent *de;
+    UNICODE_STRING str;
+    BOOLEAN spaces;
+    unsigned int count = 0, nb_buckets = 16;
+    DIR *dir;
+    int ret;
+
+    /* a change made in the same second as the scan wouldn't be noticed on
+     * file systems that only store the modification time in seconds */
+    if (st->st_mtime >= time( NULL ) - 1) return NULL;
+
+    if (!(dir = opendir( unix_name ))) return NULL;
+
+    str.Buffer = buffer;
+    str.MaximumLength = sizeof(buffer);
+    while ((de = readdir( dir )))
+    {
+        ret = ntdll_umbstowcs( 0, de->d_name, strlen(de->d_name), buffer, MAX_DIR_ENTRY_LEN );
+        if (ret <= 0) continue;
+
+        /* the list is built in reverse order, it will be reversed again when filling the buckets */
+        if (!(entry = alloc_dir_lookup_name( de->d_name, buffer, ret, FALSE ))) goto failed;
+        entry->next = names;
+        names = entry;
+        count++;
+
+        str.Length = ret * sizeof(WCHAR);
+        if (!RtlIsNameLegalDOS8Dot3( &str, NULL, &spaces ) || spaces)
+        {
+            ret = hash_short_file_name( &str, short_nameW );
+            if (!(entry = alloc_dir_lookup_name( de->d_name, short_nameW, ret, TRUE ))) goto failed;
+            entry->next = names;
+            names = entry;
+            count++;
+        }
+    }
+    closedir( dir );
+    dir = NULL;
+
+    while (nb_buckets < count) nb_buckets *= 2;
+    if (!(cache = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                                   offsetof( struct dir_lookup_cache, buckets[nb_buckets] ))))
+        goto failed;
+
+    cache->id.dev     = st->st_dev;
+    cache->id.ino     = st->st_ino;
+    cache->mtime      = st->st_mtime;
+    cache->mtime_nsec = get_mtime_nsec( st );
+    cache->nb_buckets = nb_buckets;
+
+    /* keep the directory order within each bucket so that the first matching entry wins */
+    for (entry = names; entry; entry = next)
+    {
+        struct dir_lookup_name **bucket = &cache->buckets[entry->hash & (nb_buckets - 1)];
+        next = entry->next;
+        entry->next = *bucket;
+        *bucket = entry;
+    }
+
+    list_add_head( &dir_lookup_caches, &cache->entry );
+    if (++dir_lookup_cache_count > MAX_DIR_LOOKUP_CACHES)
+        free_dir_lookup_cache( LIST_ENTRY( list_tail( &dir_lookup_caches ),
+                                           struct dir_lookup_cache, entry ));
+    TRACE( "%s: %u names in %u buckets\n", debugstr_a(unix_name), count, nb_buckets );
+    return cache;
+
+failed:
+    if (dir) closedir( dir );
+    free_dir_lookup_names( names );
+    return NULL;
+}
+
+/***********************************************************************
+ *           find_file_in_dir_cache
+ *
+ * Look for a file in the cached name index of a directory.
+ * unix_name contains the null-terminated directory name; the file found is appended at pos.
+ * Returns 1 if found, 0 if not found, and -1 if the index is not available and
+ * the directory has to be scanned.
+ */
+static int find_file_in_dir_cache( char *unix_name, int pos, const WCHAR *name, int length,
+                                   BOOLEAN check_short )
+{
+    WCHAR folded[MAX_DIR_ENTRY_LEN];
+    struct dir_lookup_cache *cache = NULL, *iter;
+    struct dir_lookup_name *entry;
+    struct stat st;
+    unsigned int hash;
+    int i, ret = 0;
+
+    if (length > MAX_DIR_ENTRY_LEN) return -1;
+    if (stat( unix_name, &st ) == -1) return -1;
+
+    for (i = 0; i < length; i++) folded[i] = tolowerW( name[i] );
+    hash = hash_dir_lookup_name( folded, length );
+
+    RtlEnterCriticalSection( &dir_lookup_section );
+
+    LIST_FOR_EACH_ENTRY( iter, &dir_lookup_caches, struct dir_lookup_cache, entry )
+    {
+        if (!is_same_file( &iter->id, &st )) continue;
+        if (iter->mtime == st.st_mtime && iter->mtime_nsec == get_mtime_nsec( &st ))
+        {
+            cache = iter;
+            list_remove( &cache->entry );
+            list_add_head( &dir_lookup_caches, &cache->entry );
+        }
+        else free_dir_lookup_cache( iter );
+        break;
+    }
+
+    if (!cache && !(cache = create_dir_lookup_cache( unix_name, &st )))
+    {
+        RtlLeaveCriticalSection( &dir_lookup_section );
+        return -1;
+    }
+
+    for (entry = cache->buckets[hash & (cache->nb_buckets - 1)]; entry; entry = entry->next)
+    {
+        if (entry->hash != hash || entry->len != length) continue;
+        if (entry->is_short && !check_short) continue;
+        if (memcmp( entry->name, folded, length * sizeof(WCHAR) )) continue;
+        unix_name[pos - 1] = '/';
+        strcpy( unix_name + pos, entry->unix_name );
+        ret = 1;
+        break;
+    }
+
+    RtlLeaveCriticalSection( &dir_lookup_section );
+    return ret;
+}
+
+
 /***********************************************************************
  *           find_file_in_dir
  *
@@ -2134,6 +2409,12 @@ static NTSTATUS find_file_in_dir( char *unix_name, int pos, const WCHAR *name, i
     }
 #endif /* VFAT_IOCTL_READDIR_BOTH */
 
+    switch (find_file_in_dir_cache( unix_name, pos, name, length, is_name_8_dot_3 ))
+    {
+    case 1: goto success;
+    case 0: goto not_found;
+    }
+
     if (!(dir = opendir( unix_name )))
     {
         if (errno == ENOENT) return STATUS_OBJECT_PATH_NOT_FOUND;
@@ -2667,6 +2667,8 @@ NTSTATUS WINAPI NtSetInformationFile(HANDLE handle, PIO_STATUS_BLOCK io,
                 io->u.Status  = wine_server_call( req );
             }
             SERVER_END_REQ;
+            if (!io->u.Status && (info->Flags & FILE_SKIP_COMPLETION_PORT_ON_SUCCESS))
+                server_set_fd_skip_completion( handle );
         } else
             io->u.Status = STATUS_INFO_LENGTH_MISMATCH;
         break;
@@ -83,6 +83,7 @@ typedef struct
 /* Value for arena 'magic' field */
 #define ARENA_INUSE_MAGIC      0x455355
 #define ARENA_PENDING_MAGIC    0xbedead
+#define ARENA_LFH_MAGIC        0x48464c
 #define ARENA_FREE_MAGIC       0x45455246
 #define ARENA_LARGE_MAGIC      0x6752614c
 
@@ -126,6 +127,11 @@ static const SIZE_T HEAP_freeListSizes[] =
 };
 #define HEAP_NB_FREE_LISTS (ARRAY_SIZE( HEAP_freeListSizes ) + HEAP_NB_SMALL_FREE_LISTS)
 
+/* Max size of the blocks kept in the low-fragmentation heap caches */
+#define HEAP_MAX_LFH_BLOCK    0x400
+#define HEAP_NB_LFH_CACHES    (((HEAP_MAX_LFH_BLOCK - HEAP_MIN_DATA_SIZE) / ALIGNMENT) + 1)
+#define HEAP_MAX_LFH_DEPTH    128  /* max number of blocks in each cache */
+
 typedef union
 {
     ARENA_FREE  arena;
@@ -164,8 +170,24 @@ typedef struct tagHEAP
     ARENA_INUSE    **pending_free;  /* Ring buffer for pending free requests */
     RTL_CRITICAL_SECTION critSection; /* Critical section for serialization */
     FREE_LIST_ENTRY *freeList;      /* Free lists */
+    SLIST_HEADER    *lfh_cache;     /* Low-fragmentation heap caches of free blocks, by size */
+    ULONGLONG        alloc_count;   /* Number of blocks allocated outside the LFH caches, including large blocks */
+    ULONGLONG        free_count;    /* Number of blocks freed outside the LFH caches, including large blocks */
 } HEAP;
 
+/* heap statistics, computed by heap_get_stats */
+struct heap_stats
+{
+    SIZE_T           committed;     /* Committed size of the sub-heaps and large blocks */
+    SIZE_T           reserved;      /* Reserved size of the sub-heaps and large blocks */
+    SIZE_T           in_use;        /* Size of the blocks in use */
+    SIZE_T           free;          /* Size of the free blocks */
+    ULONG            in_use_count;  /* Number of blocks in use, including large blocks */
+    ULONG            large_count;   /* Number of large blocks */
+    ULONG            cached_count;  /* Number of blocks in the low-fragmentation heap caches */
+    ULONG            free_lists[HEAP_NB_FREE_LISTS];  /* Number of free blocks of each free list size */
+};
+
 #define HEAP_MAGIC       ((DWORD)('H' | ('E'<<8) | ('A'<<16) | ('P'<<24)))
 
 #define HEAP_DEF_SIZE        0x110000   /* Default heap size = 1Mb + 64Kb */
@@ -296,7 +318,8 @@ static void subheap_notify_free_all(SUBHEAP const *subheap)
         {
             ARENA_INUSE const *pArena = (ARENA_INUSE const *)ptr;
             if (pArena->magic == ARENA_INUSE_MAGIC) notify_free(pArena + 1);
-            else if (pArena->magic != ARENA_PENDING_MAGIC) ERR("bad inuse_magic @%p\n", pArena);
+            else if (pArena->magic != ARENA_PENDING_MAGIC && pArena->magic != ARENA_LFH_MAGIC)
+                ERR("bad inuse_magic @%p\n", pArena);
             ptr += sizeof(*pArena) + (pArena->size & ARENA_SIZE_MASK);
         }
     }
@@ -331,26 +354,95 @@ static RTL_CRITICAL_SECTION_DEBUG process_heap_critsect_debug =
 };
 
 
+/***********************************************************************
+ *           heap_get_stats
+ *
+ * Compute the heap statistics. The heap must be locked.
+ */
+static void heap_get_stats( HEAP *heap, struct heap_stats *stats )
+{
+    SUBHEAP *subheap;
+    ARENA_LARGE *large;
+    unsigned int i;
+    char *ptr;
+
+    memset( stats, 0, sizeof(*stats) );
+
+    LIST_FOR_EACH_ENTRY( subheap, &heap->subheap_list, SUBHEAP, entry )
+    {
+        stats->committed += subheap->commitSize;
+        stats->reserved += subheap->size;
+        ptr = (char *)subheap->base + subheap->headerSize;
+        while (ptr < (char *)subheap->base + subheap->size)
+        {
+            if (*(DWORD *)ptr & ARENA_FLAG_FREE)
+            {
+                ARENA_FREE *pArena = (ARENA_FREE *)ptr;
+                SIZE_T size = pArena->size & ARENA_SIZE_MASK;
+
+                stats->free += size;
+                stats->free_lists[get_freelist_index( size + sizeof(*pArena) )]++;
+                ptr += sizeof(*pArena) + size;
+            }
+            else
+            {
+                ARENA_INUSE *pArena = (ARENA_INUSE *)ptr;
+                SIZE_T size = pArena->size & ARENA_SIZE_MASK;
+
+                if (pArena->magic == ARENA_INUSE_MAGIC)
+                {
+                    stats->in_use += size;
+                    stats->in_use_count++;
+                }
+                ptr += sizeof(*pArena) + size;
+            }
+        }
+    }
+
+    LIST_FOR_EACH_ENTRY( large, &heap->large_list, ARENA_LARGE, entry )
+    {
+        stats->committed += large->block_size;
+        stats->reserved += large->block_size;
+        stats->in_use += large->data_size;
+        stats->in_use_count++;
+        stats->large_count++;
+    }
+
+    if (heap->lfh_cache)
+        for (i = 0; i < HEAP_NB_LFH_CACHES; i++)
+            stats->cached_count += RtlQueryDepthSList( &heap->lfh_cache[i] );
+}
+
+
 /***********************************************************************
  *           HEAP_Dump
  */
 static void HEAP_Dump( HEAP *heap )
 {
+    struct heap_stats stats;
     unsigned int i;
     SUBHEAP *subheap;
     char *ptr;
 
+    heap_get_stats( heap, &stats );
+
     DPRINTF( "Heap: %p\n", heap );
+    DPRINTF( "Committed=%08lx Used=%08lx (%u blocks, %u large) Free=%08lx Cached=%u\n",
+             stats.committed, stats.in_use, stats.in_use_count, stats.large_count,
+             stats.free, stats.cached_count );
+    DPRINTF( "Allocs=%s Frees=%s\n",
+             wine_dbgstr_longlong( heap->alloc_count ), wine_dbgstr_longlong( heap->free_count ) );
     DPRINTF( "Next: %p  Sub-heaps:", LIST_ENTRY( heap->entry.next, HEAP, entry ) );
     LIST_FOR_EACH_ENTRY( subheap, &heap->subheap_list, SUBHEAP, entry ) DPRINTF( " %p", subheap );
 
     DPRINTF( "\nFree lists:\n Block   Stat   Size    Id\n" );
     for (i = 0; i < HEAP_NB_FREE_LISTS; i++)
-        DPRINTF( "%p free %08lx prev=%p next=%p\n",
+        DPRINTF( "%p free %08lx prev=%p next=%p count=%u\n",
                  &heap->freeList[i].arena, i < HEAP_NB_SMALL_FREE_LISTS ?
                  HEAP_MIN_ARENA_SIZE + i * ALIGNMENT : HEAP_freeListSizes[i - HEAP_NB_SMALL_FREE_LISTS],
                  LIST_ENTRY( heap->freeList[i].arena.entry.prev, ARENA_FREE, entry ),
-                 LIST_ENTRY( heap->freeList[i].arena.entry.next, ARENA_FREE, entry ));
+                 LIST_ENTRY( heap->freeList[i].arena.entry.next, ARENA_FREE, entry ),
+                 stats.free_lists[i] );
 
     LIST_FOR_EACH_ENTRY( subheap, &heap->subheap_list, SUBHEAP, entry )
     {
@@ -925,6 +1017,9 @@ static SUBHEAP *HEAP_CreateSubHeap( HEAP *heap, LPVOID address, DWORD flags,
         heap->flags         = flags;
         heap->magic         = HEAP_MAGIC;
         heap->grow_size     = max( HEAP_DEF_SIZE, totalSize );
+        heap->lfh_cache     = NULL;
+        heap->alloc_count   = 0;
+        heap->free_count    = 0;
         list_init( &heap->subheap_list );
         list_init( &heap->large_list );
 
@@ -1214,7 +1309,8 @@ static BOOL HEAP_ValidateInUseArena( const SUBHEAP *subheap, const ARENA_INUSE *
     }
 
     /* Check magic number */
-    if (pArena->magic != ARENA_INUSE_MAGIC && pArena->magic != ARENA_PENDING_MAGIC)
+    if (pArena->magic != ARENA_INUSE_MAGIC && pArena->magic != ARENA_PENDING_MAGIC &&
+        pArena->magic != ARENA_LFH_MAGIC)
     {
         if (quiet == NOISY) {
             ERR("Heap %p: invalid in-use arena magic %08x for %p\n", subheap->heap, pArena->magic, pArena );
@@ -1429,7 +1525,7 @@ static BOOL validate_block_pointer( HEAP *heap, SUBHEAP **ret_subheap, const ARE
         ret = HEAP_ValidateInUseArena( subheap, arena, QUIET );
     else if ((ULONG_PTR)arena % ALIGNMENT != ARENA_OFFSET)
         WARN( "Heap %p: unaligned arena pointer %p\n", subheap->heap, arena );
-    else if (arena->magic == ARENA_PENDING_MAGIC)
+    else if (arena->magic == ARENA_PENDING_MAGIC || arena->magic == ARENA_LFH_MAGIC)
         WARN( "Heap %p: block %p used after free\n", subheap->heap, arena + 1 );
     else if (arena->magic != ARENA_INUSE_MAGIC)
         WARN( "Heap %p: invalid in-use arena magic %08x for %p\n", subheap->heap, arena->magic, arena );
@@ -1447,6 +1543,122 @@ static BOOL validate_block_pointer( HEAP *heap, SUBHEAP **ret_subheap, const ARE
 }
 
 
+/***********************************************************************
+ *           lfh_allocate_block
+ *
+ * Take a block of the exact requested size from the low-fragmentation heap
+ * caches. This is done without taking the heap lock.
+ */
+static ARENA_INUSE *lfh_allocate_block( HEAP *heap, SIZE_T rounded_size )
+{
+    unsigned int index = (rounded_size - HEAP_MIN_DATA_SIZE) / ALIGNMENT;
+    ARENA_INUSE *arena;
+    SLIST_ENTRY *entry;
+
+    if (index >= HEAP_NB_LFH_CACHES) return NULL;
+    if (!(entry = RtlInterlockedPopEntrySList( &heap->lfh_cache[index] ))) return NULL;
+
+    arena = (ARENA_INUSE *)entry - 1;
+    arena->magic = ARENA_INUSE_MAGIC;
+    return arena;
+}
+
+
+/***********************************************************************
+ *           lfh_free_block
+ *
+ * Put a small block in the low-fragmentation heap caches instead of
+ * returning it to the free lists. The heap lock must be held and the block
+ * must have been validated as belonging to the heap; the block remains in
+ * use as far as the rest of the heap is concerned.
+ */
+static BOOL lfh_free_block( HEAP *heap, void *ptr )
+{
+    ARENA_INUSE *arena = (ARENA_INUSE *)ptr - 1;
+    int *magic = (int *)&arena->size + 1;  /* magic and unused_bytes */
+    SIZE_T size = arena->size & ARENA_SIZE_MASK;
+    unsigned int index;
+    int old;
+
+    if (size < HEAP_MIN_DATA_SIZE || size > HEAP_MAX_LFH_BLOCK) return FALSE;
+
+    index = (size - HEAP_MIN_DATA_SIZE) / ALIGNMENT;
+    if (RtlQueryDepthSList( &heap->lfh_cache[index] ) >= HEAP_MAX_LFH_DEPTH) return FALSE;
+
+    /* claim the block atomically, allocations pop the caches without the lock */
+    old = *(volatile int *)magic;
+    if ((old & 0xffffff) != ARENA_INUSE_MAGIC) return FALSE;
+    if (interlocked_cmpxchg( magic, (old & ~0xffffff) | ARENA_LFH_MAGIC, old ) != old) return FALSE;
+
+    mark_block_uninitialized( ptr, sizeof(SLIST_ENTRY) );
+    RtlInterlockedPushEntrySList( &heap->lfh_cache[index], ptr );
+    return TRUE;
+}
+
+
+/***********************************************************************
+ *           lfh_drain_caches
+ *
+ * Return the blocks held in the low-fragmentation heap caches to the free
+ * lists, so that they can be coalesced. The heap lock must be held.
+ */
+static BOOL lfh_drain_caches( HEAP *heap )
+{
+    SLIST_ENTRY *entry, *next;
+    ARENA_INUSE *arena;
+    BOOL ret = FALSE;
+    unsigned int i;
+
+    if (!heap->lfh_cache) return FALSE;
+
+    for (i = 0; i < HEAP_NB_LFH_CACHES; i++)
+    {
+        for (entry = RtlInterlockedFlushSList( &heap->lfh_cache[i] ); entry; entry = next)
+        {
+            next = entry->Next;
+            arena = (ARENA_INUSE *)entry - 1;
+            arena->magic = ARENA_INUSE_MAGIC;
+            HEAP_MakeInUseBlockFree( HEAP_FindSubHeap( heap, arena ), arena );
+            ret = TRUE;
+        }
+    }
+    return ret;
+}
+
+
+/***********************************************************************
+ *           heap_enable_lfh
+ *
+ * Switch a heap to low-fragmentation mode.
+ */
+static NTSTATUS heap_enable_lfh( HEAP *heap )
+{
+    SLIST_HEADER *cache = NULL;
+    SIZE_T size = HEAP_NB_LFH_CACHES * sizeof(*cache);
+    unsigned int i;
+
+    if (heap->lfh_cache) return STATUS_SUCCESS;
+
+    /* like on Windows, serialization is required, and debug heaps can't use the caches */
+    if ((heap->flags & (HEAP_NO_SERIALIZE | HEAP_SHARED | HEAP_TAIL_CHECKING_ENABLED |
+                        HEAP_FREE_CHECKING_ENABLED | HEAP_VALIDATE)) || heap->pending_free)
+        return STATUS_UNSUCCESSFUL;
+
+    /* allocated outside of the heap, so that it doesn't show up in heap walks */
+    if (NtAllocateVirtualMemory( NtCurrentProcess(), (void **)&cache, 4, &size, MEM_COMMIT, PAGE_READWRITE ))
+        return STATUS_NO_MEMORY;
+    for (i = 0; i < HEAP_NB_LFH_CACHES; i++) RtlInitializeSListHead( &cache[i] );
+
+    if (interlocked_cmpxchg_ptr( (void **)&heap->lfh_cache, cache, NULL ))
+    {
+        /* another thread got there first */
+        size = 0;
+        NtFreeVirtualMemory( NtCurrentProcess(), (void **)&cache, &size, MEM_RELEASE );
+    }
+    return STATUS_SUCCESS;
+}
+
+
 /***********************************************************************
  *           heap_set_debug_flags
  */
@@ -1638,6 +1850,13 @@ HANDLE WINAPI RtlDestroyHeap( HANDLE heap )
         addr = heapPtr->pending_free;
         NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
     }
+    if (heapPtr->lfh_cache)
+    {
+        /* the cached blocks go away with their subheaps */
+        size = 0;
+        addr = heapPtr->lfh_cache;
+        NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
+    }
     size = 0;
     addr = heapPtr->subheap.base;
     NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
@@ -1683,11 +1902,21 @@ void * WINAPI DECLSPEC_HOTPATCH RtlAllocateHeap( HANDLE heap, ULONG flags, SIZE_
     }
     if (rounded_size < HEAP_MIN_DATA_SIZE) rounded_size = HEAP_MIN_DATA_SIZE;
 
+    if (heapPtr->lfh_cache && (pInUse = lfh_allocate_block( heapPtr, rounded_size )))
+    {
+        pInUse->unused_bytes = (pInUse->size & ARENA_SIZE_MASK) - size;
+        notify_alloc( pInUse + 1, size, flags & HEAP_ZERO_MEMORY );
+        initialize_block( pInUse + 1, size, pInUse->unused_bytes, flags );
+        TRACE("(%p,%08x,%08lx): returning %p\n", heap, flags, size, pInUse + 1 );
+        return pInUse + 1;
+    }
+
     if (!(flags & HEAP_NO_SERIALIZE)) RtlEnterCriticalSection( &heapPtr->critSection );
 
     if (rounded_size >= HEAP_MIN_LARGE_BLOCK_SIZE && (flags & HEAP_GROWABLE))
     {
         void *ret = allocate_large_block( heap, flags, size );
+        if (ret) heapPtr->alloc_count++;
         if (!(flags & HEAP_NO_SERIALIZE)) RtlLeaveCriticalSection( &heapPtr->critSection );
         if (!ret && (flags & HEAP_GENERATE_EXCEPTIONS)) RtlRaiseStatus( STATUS_NO_MEMORY );
         TRACE("(%p,%08x,%08lx): returning %p\n", heap, flags, size, ret );
@@ -1696,7 +1925,13 @@ void * WINAPI DECLSPEC_HOTPATCH RtlAllocateHeap( HANDLE heap, ULONG flags, SIZE_
 
     /* Locate a suitable free block */
 
-    if (!(pArena = HEAP_FindFreeBlock( heapPtr, rounded_size, &subheap )))
+    pArena = HEAP_FindFreeBlock( heapPtr, rounded_size, &subheap );
+
+    /* Under memory pressure, return the cached blocks to the free lists and retry */
+    if (!pArena && lfh_drain_caches( heapPtr ))
+        pArena = HEAP_FindFreeBlock( heapPtr, rounded_size, &subheap );
+
+    if (!pArena)
     {
         TRACE("(%p,%08x,%08lx): returning NULL\n",
                   heap, flags, size  );
@@ -1725,6 +1960,7 @@ void * WINAPI DECLSPEC_HOTPATCH RtlAllocateHeap( HANDLE heap, ULONG flags, SIZE_
 
     notify_alloc( pInUse + 1, size, flags & HEAP_ZERO_MEMORY );
     initialize_block( pInUse + 1, size, pInUse->unused_bytes, flags );
+    heapPtr->alloc_count++;
 
     if (!(flags & HEAP_NO_SERIALIZE)) RtlLeaveCriticalSection( &heapPtr->critSection );
 
@@ -1776,9 +2012,15 @@ BOOLEAN WINAPI DECLSPEC_HOTPATCH RtlFreeHeap( HANDLE heap, ULONG flags, void *pt
     if (!validate_block_pointer( heapPtr, &subheap, pInUse )) goto error;
 
     if (!subheap)
+    {
         free_large_block( heapPtr, flags, ptr );
-    else
+        heapPtr->free_count++;
+    }
+    else if (!heapPtr->lfh_cache || !lfh_free_block( heapPtr, ptr ))
+    {
         HEAP_MakeInUseBlockFree( subheap, pInUse );
+        heapPtr->free_count++;
+    }
 
     if (!(flags & HEAP_NO_SERIALIZE)) RtlLeaveCriticalSection( &heapPtr->critSection );
     TRACE("(%p,%08x,%p): returning TRUE\n", heap, flags, ptr );
@@ -1953,12 +2195,22 @@ error:
  *  The number of bytes compacted.
  *
  * NOTES
- *  This function is a harmless stub.
+ *  This function only returns the blocks held by the low-fragmentation
+ *  heap caches to the free lists.
  */
 ULONG WINAPI RtlCompactHeap( HANDLE heap, ULONG flags )
 {
     static BOOL reported;
-    if (!reported++) FIXME( "(%p, 0x%x) stub\n", heap, flags );
+    HEAP *heapPtr = HEAP_GetPtr( heap );
+
+    if (!reported++) FIXME( "(%p, 0x%x) semi-stub\n", heap, flags );
+    if (!heapPtr) return 0;
+
+    flags &= HEAP_NO_SERIALIZE;
+    flags |= heapPtr->flags;
+    if (!(flags & HEAP_NO_SERIALIZE)) RtlEnterCriticalSection( &heapPtr->critSection );
+    lfh_drain_caches( heapPtr );
+    if (!(flags & HEAP_NO_SERIALIZE)) RtlLeaveCriticalSection( &heapPtr->critSection );
     return 0;
 }
 
@@ -2133,7 +2385,8 @@ NTSTATUS WINAPI RtlWalkHeap( HANDLE heap, PVOID entry_ptr )
         }
 
         if (((ARENA_INUSE *)ptr - 1)->magic == ARENA_INUSE_MAGIC ||
-            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_PENDING_MAGIC)
+            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_PENDING_MAGIC ||
+            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_LFH_MAGIC)
         {
             ARENA_INUSE *pArena = (ARENA_INUSE *)ptr - 1;
             ptr += pArena->size & ARENA_SIZE_MASK;
@@ -2240,12 +2493,69 @@ ULONG WINAPI RtlGetProcessHeaps( ULONG count, HANDLE *heaps )
     return total;
 }
 
+/***********************************************************************
+ *           heap_get_debug_info
+ *
+ * Fill the heap information for RtlQueryProcessDebugInformation.
+ */
+void heap_get_debug_info( HANDLE heap, DEBUG_HEAP_INFORMATION *info )
+{
+    HEAP *heapPtr = HEAP_GetPtr( heap );
+    struct heap_stats stats;
+
+    memset( info, 0, sizeof(*info) );
+    if (!heapPtr) return;
+
+    RtlEnterCriticalSection( &heapPtr->critSection );
+    heap_get_stats( heapPtr, &stats );
+    RtlLeaveCriticalSection( &heapPtr->critSection );
+
+    info->Base        = (ULONG_PTR)heap;
+    info->Flags       = heapPtr->flags;
+    info->Granularity = ALIGNMENT;
+    info->Allocated   = min( stats.in_use, ~0u );
+    info->Committed   = min( stats.committed, ~0u );
+    info->BlockCount  = stats.in_use_count;
+}
+
+
+/***********************************************************************
+ *           RtlUsageHeap    (NTDLL.@)
+ */
+NTSTATUS WINAPI RtlUsageHeap( HANDLE heap, ULONG flags, RTL_HEAP_USAGE *usage )
+{
+    HEAP *heapPtr = HEAP_GetPtr( heap );
+    struct heap_stats stats;
+
+    TRACE( "(%p,%08x,%p)\n", heap, flags, usage );
+
+    if (!heapPtr) return STATUS_INVALID_PARAMETER;
+    if (usage->Length != sizeof(*usage)) return STATUS_INFO_LENGTH_MISMATCH;
+
+    flags &= HEAP_NO_SERIALIZE;
+    flags |= heapPtr->flags;
+    if (!(flags & HEAP_NO_SERIALIZE)) RtlEnterCriticalSection( &heapPtr->critSection );
+    heap_get_stats( heapPtr, &stats );
+    if (!(flags & HEAP_NO_SERIALIZE)) RtlLeaveCriticalSection( &heapPtr->critSection );
+
+    memset( usage, 0, sizeof(*usage) );
+    usage->Length               = sizeof(*usage);
+    usage->BytesAllocated       = stats.in_use;
+    usage->BytesCommitted       = stats.committed;
+    usage->BytesReserved        = stats.reserved;
+    usage->BytesReservedMaximum = stats.reserved;
+    return STATUS_SUCCESS;
+}
+
+
 /***********************************************************************
  *           RtlQueryHeapInformation    (NTDLL.@)
  */
 NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS info_class,
                                          PVOID info, SIZE_T size_in, PSIZE_T size_out)
 {
+    HEAP *heapPtr;
+
     switch (info_class)
     {
     case HeapCompatibilityInformation:
@@ -2254,7 +2564,10 @@ NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS inf
         if (size_in < sizeof(ULONG))
             return STATUS_BUFFER_TOO_SMALL;
 
-        *(ULONG *)info = 0; /* standard heap */
+        if ((heapPtr = HEAP_GetPtr( heap )) && heapPtr->lfh_cache)
+            *(ULONG *)info = 2;  /* low-fragmentation heap */
+        else
+            *(ULONG *)info = 0;  /* standard heap */
         return STATUS_SUCCESS;
 
     default:
@@ -2268,6 +2581,27 @@ NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS inf
  */
 NTSTATUS WINAPI RtlSetHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS info_class, PVOID info, SIZE_T size)
 {
-    FIXME("%p %d %p %ld stub\n", heap, info_class, info, size);
-    return STATUS_SUCCESS;
+    HEAP *heapPtr;
+
+    switch (info_class)
+    {
+    case HeapCompatibilityInformation:
+        if (size < sizeof(ULONG)) return STATUS_BUFFER_TOO_SMALL;
+        if (!(heapPtr = HEAP_GetPtr( heap ))) return STATUS_INVALID_HANDLE;
+
+        TRACE( "%p compatibility mode %u\n", heap, *(ULONG *)info );
+        switch (*(ULONG *)info)
+        {
+        case 0:  /* standard heap, the low-fragmentation heap can't be disabled */
+            return heapPtr->lfh_cache ? STATUS_UNSUCCESSFUL : STATUS_SUCCESS;
+        case 2:  /* low-fragmentation heap */
+            return heap_enable_lfh( heapPtr );
+        default:
+            return STATUS_UNSUCCESSFUL;
+        }
+
+    default:
+        FIXME("%p %d %p %ld stub\n", heap, info_class, info, size);
+        return STATUS_SUCCESS;
+    }
 }
@@ -102,8 +102,16 @@ typedef struct _wine_modref
     int                   alloc_deps;
     int                   nDeps;
     struct _wine_modref **deps;
+    struct _wine_modref  *next_basename;  /* next module in the base name hash chain */
+    struct _wine_modref  *next_fullname;  /* next module in the full name hash chain */
 } WINE_MODREF;
 
+#define MODULE_HASH_SIZE 64
+
+/* loaded modules hashed by base name and full name, in load order within each chain */
+static WINE_MODREF *basename_hash[MODULE_HASH_SIZE];
+static WINE_MODREF *fullname_hash[MODULE_HASH_SIZE];
+
 /* info about the current builtin dll load */
 /* used to keep track of things across the register_dll constructor call */
 struct builtin_load_info
@@ -399,6 +407,56 @@ static WINE_MODREF *get_modref( HMODULE hmod )
 }
 
 
+/* case-insensitive hash of a module name */
+static unsigned int hash_module_name( LPCWSTR name )
+{
+    unsigned int hash = 0;
+
+    while (*name) hash = hash * 65599 + tolowerW( *name++ );
+    return hash % MODULE_HASH_SIZE;
+}
+
+
+/**********************************************************************
+ *	    add_module_to_hash
+ *
+ * Add a module to the name hash tables.
+ * The loader_section must be locked while calling this function
+ */
+static void add_module_to_hash( WINE_MODREF *wm )
+{
+    WINE_MODREF **ptr;
+
+    ptr = &basename_hash[hash_module_name( wm->ldr.BaseDllName.Buffer )];
+    while (*ptr) ptr = &(*ptr)->next_basename;
+    *ptr = wm;
+
+    ptr = &fullname_hash[hash_module_name( wm->ldr.FullDllName.Buffer )];
+    while (*ptr) ptr = &(*ptr)->next_fullname;
+    *ptr = wm;
+}
+
+
+/**********************************************************************
+ *	    remove_module_from_hash
+ *
+ * Remove a module from the name hash tables.
+ * The loader_section must be locked while calling this function
+ */
+static void remove_module_from_hash( WINE_MODREF *wm )
+{
+    WINE_MODREF **ptr;
+
+    ptr = &basename_hash[hash_module_name( wm->ldr.BaseDllName.Buffer )];
+    while (*ptr && *ptr != wm) ptr = &(*ptr)->next_basename;
+    if (*ptr) *ptr = wm->next_basename;
+
+    ptr = &fullname_hash[hash_module_name( wm->ldr.FullDllName.Buffer )];
+    while (*ptr && *ptr != wm) ptr = &(*ptr)->next_fullname;
+    if (*ptr) *ptr = wm->next_fullname;
+}
+
+
 /**********************************************************************
  *	    find_basename_module
  *
@@ -407,18 +465,16 @@ static WINE_MODREF *get_modref( HMODULE hmod )
  */
 static WINE_MODREF *find_basename_module( LPCWSTR name )
 {
-    PLIST_ENTRY mark, entry;
+    WINE_MODREF *wm;
 
     if (cached_modref && !strcmpiW( name, cached_modref->ldr.BaseDllName.Buffer ))
         return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
-    for (entry = mark->Flink; entry != mark; entry = entry->Flink)
+    for (wm = basename_hash[hash_module_name( name )]; wm; wm = wm->next_basename)
     {
-        LDR_MODULE *mod = CONTAINING_RECORD(entry, LDR_MODULE, InLoadOrderModuleList);
-        if (!strcmpiW( name, mod->BaseDllName.Buffer ))
+        if (!strcmpiW( name, wm->ldr.BaseDllName.Buffer ))
         {
-            cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
+            cached_modref = wm;
             return cached_modref;
         }
     }
@@ -434,18 +490,16 @@ static WINE_MODREF *find_basename_module( LPCWSTR name )
  */
 static WINE_MODREF *find_fullname_module( LPCWSTR name )
 {
-    PLIST_ENTRY mark, entry;
+    WINE_MODREF *wm;
 
     if (cached_modref && !strcmpiW( name, cached_modref->ldr.FullDllName.Buffer ))
         return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
-    for (entry = mark->Flink; entry != mark; entry = entry->Flink)
+    for (wm = fullname_hash[hash_module_name( name )]; wm; wm = wm->next_fullname)
     {
-        LDR_MODULE *mod = CONTAINING_RECORD(entry, LDR_MODULE, InLoadOrderModuleList);
-        if (!strcmpiW( name, mod->FullDllName.Buffer ))
+        if (!strcmpiW( name, wm->ldr.FullDllName.Buffer ))
         {
-            cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
+            cached_modref = wm;
             return cached_modref;
         }
     }
@@ -1094,6 +1148,7 @@ static WINE_MODREF *alloc_module( HMODULE hModule, LPCWSTR filename )
                    &wm->ldr.InLoadOrderModuleList);
     InsertTailList(&NtCurrentTeb()->Peb->LdrData->InMemoryOrderModuleList,
                    &wm->ldr.InMemoryOrderModuleList);
+    add_module_to_hash( wm );
     /* wait until init is called for inserting into InInitializationOrderModuleList */
 
     if (!(nt->OptionalHeader.DllCharacteristics & IMAGE_DLLCHARACTERISTICS_NX_COMPAT))
@@ -1768,6 +1823,7 @@ static void load_builtin_callback( void *module, const char *filename )
             /* the module has only be inserted in the load & memory order lists */
             RemoveEntryList(&wm->ldr.InLoadOrderModuleList);
             RemoveEntryList(&wm->ldr.InMemoryOrderModuleList);
+            remove_module_from_hash( wm );
             /* FIXME: free the modref */
             builtin_load_info->status = STATUS_DLL_NOT_FOUND;
             return;
@@ -2069,6 +2125,7 @@ static NTSTATUS load_native_dll( LPCWSTR load_path, LPCWSTR name, HANDLE file,
             /* the module has only be inserted in the load & memory order lists */
             RemoveEntryList(&wm->ldr.InLoadOrderModuleList);
             RemoveEntryList(&wm->ldr.InMemoryOrderModuleList);
+            remove_module_from_hash( wm );
 
             /* FIXME: there are several more dangling references
              * left. Including dlls loaded by this dll before the
@@ -3085,6 +3142,7 @@ static void free_modref( WINE_MODREF *wm )
 {
     RemoveEntryList(&wm->ldr.InLoadOrderModuleList);
     RemoveEntryList(&wm->ldr.InMemoryOrderModuleList);
+    remove_module_from_hash( wm );
     if (wm->ldr.InInitializationOrderModuleList.Flink)
         RemoveEntryList(&wm->ldr.InInitializationOrderModuleList);
 
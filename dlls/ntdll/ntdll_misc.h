@@ -80,6 +80,7 @@ extern void virtual_init(void) DECLSPEC_HIDDEN;
 extern void virtual_init_threading(void) DECLSPEC_HIDDEN;
 extern void fill_cpu_info(void) DECLSPEC_HIDDEN;
 extern void heap_set_debug_flags( HANDLE handle ) DECLSPEC_HIDDEN;
+extern void heap_get_debug_info( HANDLE handle, DEBUG_HEAP_INFORMATION *info ) DECLSPEC_HIDDEN;
 
 /* server support */
 extern timeout_t server_start_time DECLSPEC_HIDDEN;
@@ -100,6 +101,8 @@ extern unsigned int server_queue_process_apc( HANDLE process, const apc_call_t *
 extern int server_remove_fd_from_cache( HANDLE handle ) DECLSPEC_HIDDEN;
 extern int server_get_unix_fd( HANDLE handle, unsigned int access, int *unix_fd,
                                int *needs_close, enum server_fd_type *type, unsigned int *options ) DECLSPEC_HIDDEN;
+extern void server_set_fd_skip_completion( HANDLE handle ) DECLSPEC_HIDDEN;
+extern BOOL server_get_fd_skip_completion( HANDLE handle ) DECLSPEC_HIDDEN;
 extern int server_pipe( int fd[2] ) DECLSPEC_HIDDEN;
 extern NTSTATUS alloc_object_attributes( const OBJECT_ATTRIBUTES *attr, struct object_attributes **ret,
                                          data_size_t *ret_len ) DECLSPEC_HIDDEN;
@@ -248,6 +251,13 @@ static inline struct ntdll_thread_data *ntdll_get_thread_data(void)
 extern mode_t FILE_umask DECLSPEC_HIDDEN;
 extern HANDLE keyed_event DECLSPEC_HIDDEN;
 
+#ifdef __linux__
+struct timespec;
+extern int futex_wait( const int *addr, int val, struct timespec *timeout ) DECLSPEC_HIDDEN;
+extern int futex_wake( const int *addr, int val ) DECLSPEC_HIDDEN;
+extern int use_futexes(void) DECLSPEC_HIDDEN;
+#endif
+
 #define HASH_STRING_ALGORITHM_DEFAULT  0
 #define HASH_STRING_ALGORITHM_X65599   1
 #define HASH_STRING_ALGORITHM_INVALID  0xffffffff
@@ -140,6 +140,17 @@ static inline LONG64 interlocked_xchg64( LONG64 *dest, LONG64 val )
 #endif
 }
 
+/* atomically read a 64-bit value */
+static inline LONG64 interlocked_read64( LONG64 *src )
+{
+#ifdef _WIN64
+    /* aligned 64-bit loads are atomic, avoid a locked operation on the shared cache line */
+    return *(volatile LONG64 *)src;
+#else
+    return interlocked_cmpxchg64( src, 0, 0 );
+#endif
+}
+
 #ifdef __GNUC__
 static void fatal_error( const char *err, ... ) __attribute__((noreturn, format(printf,1,2)));
 static void fatal_perror( const char *err, ... ) __attribute__((noreturn, format(printf,1,2)));
@@ -270,9 +281,28 @@ static void read_reply_data( void *buffer, size_t size )
  */
 static inline unsigned int wait_reply( struct __server_request_info *req )
 {
-    read_reply_data( &req->u.reply, sizeof(req->u.reply) );
-    if (req->u.reply.reply_header.reply_size)
-        read_reply_data( req->reply_data, req->u.reply.reply_header.reply_size );
+    data_size_t max_size = req->u.req.request_header.reply_size;
+    struct iovec vec[2];
+    int ret;
+
+    /* read the reply data along with the reply, the server sends both at once */
+    vec[0].iov_base = &req->u.reply;
+    vec[0].iov_len  = sizeof(req->u.reply);
+    vec[1].iov_base = req->reply_data;
+    vec[1].iov_len  = max_size;
+
+    if ((ret = readv( ntdll_get_thread_data()->reply_fd, vec, max_size ? 2 : 1 )) < 0)
+        ret = 0;  /* let read_reply_data handle the error */
+
+    if (ret < sizeof(req->u.reply))
+    {
+        read_reply_data( (char *)&req->u.reply + ret, sizeof(req->u.reply) - ret );
+        ret = 0;
+    }
+    else ret -= sizeof(req->u.reply);
+
+    if (req->u.reply.reply_header.reply_size > ret)
+        read_reply_data( (char *)req->reply_data + ret, req->u.reply.reply_header.reply_size - ret );
     return req->u.reply.reply_header.error;
 }
 
@@ -814,7 +844,8 @@ union fd_cache_entry
     struct
     {
         int fd;
-        enum server_fd_type type : 5;
+        enum server_fd_type type : 4;
+        unsigned int        skip_completion : 1;  /* FILE_SKIP_COMPLETION_PORT_ON_SUCCESS is set */
         unsigned int        access : 3;
         unsigned int        options : 24;
     } s;
@@ -868,6 +899,7 @@ static BOOL add_fd_to_cache( HANDLE handle, int fd, enum server_fd_type type,
     /* store fd+1 so that 0 can be used as the unset value */
     cache.s.fd = fd + 1;
     cache.s.type = type;
+    cache.s.skip_completion = 0;
     cache.s.access = access;
     cache.s.options = options;
     cache.data = interlocked_xchg64( &fd_cache[entry][idx].data, cache.data );
@@ -887,7 +919,7 @@ static inline NTSTATUS get_cached_fd( HANDLE handle, int *fd, enum server_fd_typ
 
     if (entry >= FD_CACHE_ENTRIES || !fd_cache[entry]) return STATUS_INVALID_HANDLE;
 
-    cache.data = interlocked_cmpxchg64( &fd_cache[entry][idx].data, 0, 0 );
+    cache.data = interlocked_read64( &fd_cache[entry][idx].data );
     if (!cache.data) return STATUS_INVALID_HANDLE;
 
     /* if fd type is invalid, fd stores an error value */
@@ -920,6 +952,53 @@ int server_remove_fd_from_cache( HANDLE handle )
 }
 
 
+/***********************************************************************
+ *           server_set_fd_skip_completion
+ *
+ * Remember that completions of I/O that completes synchronously on a handle
+ * are never queued, so that they don't need a server call. The flag can't be
+ * removed once set; if the handle can't be cached we simply keep asking the server.
+ */
+void server_set_fd_skip_completion( HANDLE handle )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+    union fd_cache_entry cache, old;
+    int fd, needs_close;
+
+    /* make sure the fd is in the cache */
+    if (server_get_unix_fd( handle, 0, &fd, &needs_close, NULL, NULL )) return;
+    if (needs_close)
+    {
+        close( fd );
+        return;
+    }
+
+    do
+    {
+        old.data = interlocked_read64( &fd_cache[entry][idx].data );
+        if (!old.data || old.s.type == FD_TYPE_INVALID) return;
+        cache = old;
+        cache.s.skip_completion = 1;
+    } while (interlocked_cmpxchg64( &fd_cache[entry][idx].data, cache.data, old.data ) != old.data);
+}
+
+
+/***********************************************************************
+ *           server_get_fd_skip_completion
+ *
+ * Check if completions of synchronously completed I/O are known to be skipped for a handle.
+ */
+BOOL server_get_fd_skip_completion( HANDLE handle )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+    union fd_cache_entry cache;
+
+    if (entry >= FD_CACHE_ENTRIES || !fd_cache[entry]) return FALSE;
+    cache.data = interlocked_read64( &fd_cache[entry][idx].data );
+    return cache.data && cache.s.type != FD_TYPE_INVALID && cache.s.skip_completion;
+}
+
+
 /***********************************************************************
  *           server_get_unix_fd
  *
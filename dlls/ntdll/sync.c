@@ -42,6 +42,7 @@
 #ifdef HAVE_SCHED_H
 # include <sched.h>
 #endif
+#include <limits.h>
 #include <string.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -63,17 +64,67 @@ HANDLE keyed_event = NULL;
 
 static const LARGE_INTEGER zero_timeout;
 
-static inline int interlocked_dec_if_nonzero( int *dest )
+#ifdef __linux__
+
+static void timespec_from_timeout( struct timespec *timespec, const LARGE_INTEGER *timeout )
 {
-    int val, tmp;
-    for (val = *dest;; val = tmp)
+    LARGE_INTEGER now;
+    timeout_t diff;
+
+    if (timeout->QuadPart > 0)
     {
-        if (!val || (tmp = interlocked_cmpxchg( dest, val - 1, val )) == val)
-            break;
+        NtQuerySystemTime( &now );
+        diff = timeout->QuadPart - now.QuadPart;
+        if (diff < 0) diff = 0;
     }
-    return val;
+    else
+        diff = -timeout->QuadPart;
+
+    timespec->tv_sec  = diff / 10000000;
+    timespec->tv_nsec = (diff % 10000000) * 100;
 }
 
+static NTSTATUS fast_wait_cv( int *futex, int val, const LARGE_INTEGER *timeout )
+{
+    struct timespec timespec;
+    int ret;
+
+    if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
+
+    if (timeout && timeout->QuadPart != TIMEOUT_INFINITE)
+    {
+        timespec_from_timeout( &timespec, timeout );
+        ret = futex_wait( futex, val, &timespec );
+    }
+    else
+        ret = futex_wait( futex, val, NULL );
+
+    if (ret == -1 && errno == ETIMEDOUT) return STATUS_TIMEOUT;
+    return STATUS_WAIT_0;
+}
+
+static NTSTATUS fast_wake_cv( int *futex, int count )
+{
+    if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
+
+    futex_wake( futex, count );
+    return STATUS_SUCCESS;
+}
+
+#else
+
+static NTSTATUS fast_wait_cv( int *futex, int val, const LARGE_INTEGER *timeout )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static NTSTATUS fast_wake_cv( int *futex, int count )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+#endif
+
 /* creates a struct security_descriptor and contained information in one contiguous piece of memory */
 NTSTATUS alloc_object_attributes( const OBJECT_ATTRIBUTES *attr, struct object_attributes **ret,
                                   data_size_t *ret_len )
@@ -1344,8 +1395,9 @@ NTSTATUS WINAPI NtRemoveIoCompletion( HANDLE CompletionPort, PULONG_PTR Completi
 NTSTATUS WINAPI NtRemoveIoCompletionEx( HANDLE port, FILE_IO_COMPLETION_INFORMATION *info, ULONG count,
                                         ULONG *written, LARGE_INTEGER *timeout, BOOLEAN alertable )
 {
+    completion_msg_t msgs[64];
     NTSTATUS ret;
-    ULONG i = 0;
+    ULONG i = 0, j, nb_msgs, max_msgs;
 
     TRACE("%p %p %u %p %p %u\n", port, info, count, written, timeout, alertable);
 
@@ -1353,22 +1405,32 @@ NTSTATUS WINAPI NtRemoveIoCompletionEx( HANDLE port, FILE_IO_COMPLETION_INFORMAT
     {
         while (i < count)
         {
-            SERVER_START_REQ( remove_completion )
+            max_msgs = min( count - i, ARRAY_SIZE(msgs) );
+            nb_msgs = 0;
+
+            SERVER_START_REQ( remove_completions )
             {
                 req->handle = wine_server_obj_handle( port );
+                wine_server_set_reply( req, msgs, max_msgs * sizeof(*msgs) );
                 if (!(ret = wine_server_call( req )))
-                {
-                    info[i].CompletionKey             = reply->ckey;
-                    info[i].CompletionValue           = reply->cvalue;
-                    info[i].IoStatusBlock.Information = reply->information;
-                    info[i].IoStatusBlock.u.Status    = reply->status;
-                }
+                    nb_msgs = wine_server_reply_size( reply ) / sizeof(*msgs);
             }
             SERVER_END_REQ;
 
-            if (ret != STATUS_SUCCESS) break;
+            for (j = 0; j < nb_msgs; j++, i++)
+            {
+                info[i].CompletionKey             = msgs[j].ckey;
+                info[i].CompletionValue           = msgs[j].cvalue;
+                info[i].IoStatusBlock.Information = msgs[j].information;
+                info[i].IoStatusBlock.u.Status    = msgs[j].status;
+            }
 
-            ++i;
+            if (ret != STATUS_SUCCESS) break;
+            if (nb_msgs < max_msgs)  /* queue is empty now */
+            {
+                ret = STATUS_PENDING;
+                break;
+            }
         }
 
         if (i || ret != STATUS_PENDING)
@@ -1475,6 +1537,9 @@ NTSTATUS NTDLL_AddCompletion( HANDLE hFile, ULONG_PTR CompletionValue,
 {
     NTSTATUS status;
 
+    /* the server wouldn't queue it anyway */
+    if (server_get_fd_skip_completion( hFile )) return STATUS_SUCCESS;
+
     SERVER_START_REQ( add_fd_completion )
     {
         req->handle      = wine_server_obj_handle( hFile );
@@ -1868,8 +1933,9 @@ void WINAPI RtlInitializeConditionVariable( RTL_CONDITION_VARIABLE *variable )
  */
 void WINAPI RtlWakeConditionVariable( RTL_CONDITION_VARIABLE *variable )
 {
-    if (interlocked_dec_if_nonzero( (int *)&variable->Ptr ))
-        NtReleaseKeyedEvent( 0, &variable->Ptr, FALSE, NULL );
+    interlocked_xchg_add( (int *)&variable->Ptr, 1 );
+    if (fast_wake_cv( (int *)&variable->Ptr, 1 ) == STATUS_NOT_IMPLEMENTED)
+        RtlWakeAddressSingle( variable );
 }
 
 /***********************************************************************
@@ -1879,9 +1945,9 @@ void WINAPI RtlWakeConditionVariable( RTL_CONDITION_VARIABLE *variable )
  */
 void WINAPI RtlWakeAllConditionVariable( RTL_CONDITION_VARIABLE *variable )
 {
-    int val = interlocked_xchg( (int *)&variable->Ptr, 0 );
-    while (val-- > 0)
-        NtReleaseKeyedEvent( 0, &variable->Ptr, FALSE, NULL );
+    interlocked_xchg_add( (int *)&variable->Ptr, 1 );
+    if (fast_wake_cv( (int *)&variable->Ptr, INT_MAX ) == STATUS_NOT_IMPLEMENTED)
+        RtlWakeAddressAll( variable );
 }
 
 /***********************************************************************
@@ -1897,21 +1963,18 @@ void WINAPI RtlWakeAllConditionVariable( RTL_CONDITION_VARIABLE *variable )
  *  timeout   [I]   timeout
  *
  * RETURNS
- *  see NtWaitForKeyedEvent for all possible return values.
+ *  see RtlWaitOnAddress for all possible return values.
  */
 NTSTATUS WINAPI RtlSleepConditionVariableCS( RTL_CONDITION_VARIABLE *variable, RTL_CRITICAL_SECTION *crit,
                                              const LARGE_INTEGER *timeout )
 {
     NTSTATUS status;
-    interlocked_xchg_add( (int *)&variable->Ptr, 1 );
+    int val = *(int *)&variable->Ptr;
+
     RtlLeaveCriticalSection( crit );
 
-    status = NtWaitForKeyedEvent( 0, &variable->Ptr, FALSE, timeout );
-    if (status != STATUS_SUCCESS)
-    {
-        if (!interlocked_dec_if_nonzero( (int *)&variable->Ptr ))
-            status = NtWaitForKeyedEvent( 0, &variable->Ptr, FALSE, NULL );
-    }
+    if ((status = fast_wait_cv( (int *)&variable->Ptr, val, timeout )) == STATUS_NOT_IMPLEMENTED)
+        status = RtlWaitOnAddress( &variable->Ptr, &val, sizeof(int), timeout );
 
     RtlEnterCriticalSection( crit );
     return status;
@@ -1931,7 +1994,7 @@ NTSTATUS WINAPI RtlSleepConditionVariableCS( RTL_CONDITION_VARIABLE *variable, R
  *  flags     [I]   type of the current lock (exclusive / shared)
  *
  * RETURNS
- *  see NtWaitForKeyedEvent for all possible return values.
+ *  see RtlWaitOnAddress for all possible return values.
  *
  * NOTES
  *  the behaviour is undefined if the thread doesn't own the lock.
@@ -1940,19 +2003,15 @@ NTSTATUS WINAPI RtlSleepConditionVariableSRW( RTL_CONDITION_VARIABLE *variable,
                                               const LARGE_INTEGER *timeout, ULONG flags )
 {
     NTSTATUS status;
-    interlocked_xchg_add( (int *)&variable->Ptr, 1 );
+    int val = *(int *)&variable->Ptr;
 
     if (flags & RTL_CONDITION_VARIABLE_LOCKMODE_SHARED)
         RtlReleaseSRWLockShared( lock );
     else
         RtlReleaseSRWLockExclusive( lock );
 
-    status = NtWaitForKeyedEvent( 0, &variable->Ptr, FALSE, timeout );
-    if (status != STATUS_SUCCESS)
-    {
-        if (!interlocked_dec_if_nonzero( (int *)&variable->Ptr ))
-            status = NtWaitForKeyedEvent( 0, &variable->Ptr, FALSE, NULL );
-    }
+    if ((status = fast_wait_cv( (int *)&variable->Ptr, val, timeout )) == STATUS_NOT_IMPLEMENTED)
+        status = RtlWaitOnAddress( &variable->Ptr, &val, sizeof(int), timeout );
 
     if (flags & RTL_CONDITION_VARIABLE_LOCKMODE_SHARED)
         RtlAcquireSRWLockShared( lock );
@@ -56,6 +56,7 @@ static LPWSTR   (__cdecl *p_wcsupr)(LPWSTR);
 
 static LPWSTR   (WINAPIV *p_wcschr)(LPCWSTR, WCHAR);
 static LPWSTR   (WINAPIV *p_wcsrchr)(LPCWSTR, WCHAR);
+static INT      (__cdecl *p_wcslen)(LPCWSTR);
 
 static void     (__cdecl *p_qsort)(void *,size_t,size_t, int(__cdecl *compar)(const void *, const void *) );
 static void*    (__cdecl *p_bsearch)(void *,void*,size_t,size_t, int(__cdecl *compar)(const void *, const void *) );
@@ -95,6 +96,7 @@ static void InitFunctionPtrs(void)
 
 	p_wcschr= (void *)GetProcAddress(hntdll, "wcschr");
 	p_wcsrchr= (void *)GetProcAddress(hntdll, "wcsrchr");
+	p_wcslen= (void *)GetProcAddress(hntdll, "wcslen");
 	p_qsort= (void *)GetProcAddress(hntdll, "qsort");
 	p_bsearch= (void *)GetProcAddress(hntdll, "bsearch");
 
@@ -1127,6 +1129,57 @@ static void test_wcschr(void)
        "wcschr should have returned NULL\n");
 }
 
+static void test_wcschr_wcslen_boundaries(void)
+{
+    WCHAR buffer[64], *page, *end, *ret;
+    int i, len, offset;
+
+    /* strings at every alignment, with the match and the terminator at every position */
+    for (offset = 0; offset < 8; offset++)
+    {
+        for (len = 0; len < 24; len++)
+        {
+            WCHAR *str = buffer + offset;
+
+            for (i = 0; i < len; i++) str[i] = 'a' + i;
+            str[len] = 0;
+            str[len + 1] = 'x';
+            str[len + 2] = 0;
+
+            ok(p_wcslen(str) == len, "offset %d: got length %d, expected %d\n",
+               offset, p_wcslen(str), len);
+            ok(p_wcschr(str, 0) == str + len, "offset %d, length %d: wrong terminator\n", offset, len);
+            ok(p_wcschr(str, 'x') == NULL, "offset %d, length %d: found character after terminator\n",
+               offset, len);
+            for (i = 0; i < len; i++)
+            {
+                ret = p_wcschr(str, 'a' + i);
+                ok(ret == str + i, "offset %d, length %d: got %p, expected %p\n",
+                   offset, len, ret, str + i);
+            }
+        }
+    }
+
+    /* strings ending right before an inaccessible page */
+    page = VirtualAlloc(NULL, 0x2000, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    ok(page != NULL, "VirtualAlloc failed\n");
+    if (!page) return;
+    VirtualFree((char *)page + 0x1000, 0x1000, MEM_DECOMMIT);
+    end = (WCHAR *)((char *)page + 0x1000);
+    for (len = 0; len < 24; len++)
+    {
+        WCHAR *str = end - len - 1;
+
+        for (i = 0; i < len; i++) str[i] = 'a' + i;
+        str[len] = 0;
+        ok(p_wcslen(str) == len, "got length %d, expected %d\n", p_wcslen(str), len);
+        ok(p_wcschr(str, 'z') == NULL, "length %d: unexpected match\n", len);
+        if (len)
+            ok(p_wcschr(str, 'a' + len - 1) == str + len - 1, "length %d: wrong match\n", len);
+    }
+    VirtualFree(page, 0, MEM_RELEASE);
+}
+
 static void test_wcsrchr(void)
 {
     static const WCHAR teststringW[] = {'a','b','r','a','c','a','d','a','b','r','a',0};
@@ -1349,6 +1402,8 @@ START_TEST(string)
         test_wtoi64();
     if (p_wcschr)
         test_wcschr();
+    if (p_wcschr && p_wcslen)
+        test_wcschr_wcslen_boundaries();
     if (p_wcsrchr)
         test_wcsrchr();
     if (p_wcslwr && p_wcsupr)
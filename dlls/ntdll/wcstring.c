@@ -33,6 +33,11 @@
 #include "winternl.h"
 #include "wine/unicode.h"
 
+/* helpers for scanning a string one ULONG_PTR (several WCHARs) at a time,
+ * HAS_NULL_WCHAR(v) is non-zero if any of the WCHARs in v is zero */
+#define WCHAR_ONES (~(ULONG_PTR)0 / 0xffff)
+#define HAS_NULL_WCHAR(v) (((v) - WCHAR_ONES) & ~(v) & (WCHAR_ONES << 15))
+
 /*********************************************************************
  *           _wcsicmp    (NTDLL.@)
  */
@@ -101,7 +106,18 @@ LPWSTR __cdecl NTDLL_wcscat( LPWSTR dst, LPCWSTR src )
  */
 LPWSTR __cdecl NTDLL_wcschr( LPCWSTR str, WCHAR ch )
 {
-    return strchrW( str, ch );
+    const ULONG_PTR *p;
+    ULONG_PTR mask = ch * WCHAR_ONES;
+
+    if ((ULONG_PTR)str & 1) return strchrW( str, ch );
+    for (; (ULONG_PTR)str & (sizeof(ULONG_PTR) - 1); str++)
+    {
+        if (*str == ch) return (LPWSTR)str;
+        if (!*str) return NULL;
+    }
+    /* aligned reads never cross a page boundary, so reading past the terminator is safe */
+    for (p = (const ULONG_PTR *)str; !HAS_NULL_WCHAR(*p) && !HAS_NULL_WCHAR(*p ^ mask); p++) ;
+    return strchrW( (LPCWSTR)p, ch );
 }
 
 
@@ -137,7 +153,14 @@ INT __cdecl NTDLL_wcscspn( LPCWSTR str, LPCWSTR reject )
  */
 INT __cdecl NTDLL_wcslen( LPCWSTR str )
 {
-    return strlenW( str );
+    const WCHAR *s = str;
+    const ULONG_PTR *p;
+
+    if ((ULONG_PTR)s & 1) return strlenW( str );
+    for (; (ULONG_PTR)s & (sizeof(ULONG_PTR) - 1); s++) if (!*s) return s - str;
+    for (p = (const ULONG_PTR *)s; !HAS_NULL_WCHAR(*p); p++) ;
+    for (s = (const WCHAR *)p; *s; s++) ;
+    return s - str;
 }
 
 
@@ -28,12 +28,14 @@
 #include "wined3d_private.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d);
+WINE_DECLARE_DEBUG_CHANNEL(d3d_perf);
 
 #define WINED3D_BUFFER_HASDESC      0x01    /* A vertex description has been found. */
 #define WINED3D_BUFFER_USE_BO       0x02    /* Use a buffer object for this buffer. */
 #define WINED3D_BUFFER_PIN_SYSMEM   0x04    /* Keep a system memory copy for this buffer. */
 #define WINED3D_BUFFER_DISCARD      0x08    /* A DISCARD lock has occurred since the last preload. */
 #define WINED3D_BUFFER_APPLESYNC    0x10    /* Using sync as in GL_APPLE_flush_buffer_range. */
+#define WINED3D_BUFFER_PERSISTENT   0x20    /* Using persistently mapped stream buffer objects. */
 
 #define VB_MAXDECLCHANGES     100     /* After that number of decl changes we stop converting */
 #define VB_RESETDECLCHANGE    1000    /* Reset the decl changecount after that number of draws */
@@ -138,36 +140,41 @@ static void wined3d_buffer_gl_bind(struct wined3d_buffer_gl *buffer_gl, struct w
     context_bind_bo(context, buffer_gl->buffer_type_hint, buffer_gl->buffer_object);
 }
 
+/* The stream source state handler might have read the memory of the vertex
+ * buffer already and got the memory in the vbo which is not valid any
+ * longer. Dirtify the stream source to force a reload. This happens only once
+ * per changed vertexbuffer and should occur rather rarely. */
+static void buffer_invalidate_bind_state(struct wined3d_resource *resource)
+{
+    if (resource->bind_flags & WINED3D_BIND_VERTEX_BUFFER)
+        device_invalidate_state(resource->device, STATE_STREAMSRC);
+    if (resource->bind_flags & WINED3D_BIND_INDEX_BUFFER)
+        device_invalidate_state(resource->device, STATE_INDEXBUFFER);
+    if (resource->bind_flags & WINED3D_BIND_CONSTANT_BUFFER)
+    {
+        device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_VERTEX));
+        device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_HULL));
+        device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_DOMAIN));
+        device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_GEOMETRY));
+        device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_PIXEL));
+        device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_COMPUTE));
+    }
+}
+
 /* Context activation is done by the caller. */
 static void wined3d_buffer_gl_destroy_buffer_object(struct wined3d_buffer_gl *buffer_gl,
         struct wined3d_context *context)
 {
     struct wined3d_resource *resource = &buffer_gl->b.resource;
     const struct wined3d_gl_info *gl_info = context->gl_info;
+    unsigned int i;
 
     if (!buffer_gl->buffer_object)
         return;
 
-    /* The stream source state handler might have read the memory of the
-     * vertex buffer already and got the memory in the vbo which is not
-     * valid any longer. Dirtify the stream source to force a reload. This
-     * happens only once per changed vertexbuffer and should occur rather
-     * rarely. */
     if (resource->bind_count)
     {
-        if (resource->bind_flags & WINED3D_BIND_VERTEX_BUFFER)
-            device_invalidate_state(resource->device, STATE_STREAMSRC);
-        if (resource->bind_flags & WINED3D_BIND_INDEX_BUFFER)
-            device_invalidate_state(resource->device, STATE_INDEXBUFFER);
-        if (resource->bind_flags & WINED3D_BIND_CONSTANT_BUFFER)
-        {
-            device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_VERTEX));
-            device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_HULL));
-            device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_DOMAIN));
-            device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_GEOMETRY));
-            device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_PIXEL));
-            device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_COMPUTE));
-        }
+        buffer_invalidate_bind_state(resource);
         if (resource->bind_flags & WINED3D_BIND_STREAM_OUTPUT)
         {
             device_invalidate_state(resource->device, STATE_STREAM_OUTPUT);
@@ -182,7 +189,22 @@ static void wined3d_buffer_gl_destroy_buffer_object(struct wined3d_buffer_gl *bu
         }
     }
 
-    GL_EXTCALL(glDeleteBuffers(1, &buffer_gl->buffer_object));
+    if (buffer_gl->b.flags & WINED3D_BUFFER_PERSISTENT)
+    {
+        for (i = 0; i < buffer_gl->stream_bo_count; ++i)
+        {
+            GL_EXTCALL(glDeleteBuffers(1, &buffer_gl->stream_bos[i].name));
+            if (buffer_gl->stream_bos[i].fence)
+                wined3d_fence_destroy(buffer_gl->stream_bos[i].fence);
+        }
+        memset(buffer_gl->stream_bos, 0, sizeof(buffer_gl->stream_bos));
+        buffer_gl->stream_bo_count = 0;
+        buffer_gl->stream_bo_idx = 0;
+    }
+    else
+    {
+        GL_EXTCALL(glDeleteBuffers(1, &buffer_gl->buffer_object));
+    }
     checkGLcall("glDeleteBuffers");
     buffer_gl->buffer_object = 0;
 
@@ -191,7 +213,60 @@ static void wined3d_buffer_gl_destroy_buffer_object(struct wined3d_buffer_gl *bu
         wined3d_fence_destroy(buffer_gl->b.fence);
         buffer_gl->b.fence = NULL;
     }
-    buffer_gl->b.flags &= ~WINED3D_BUFFER_APPLESYNC;
+    buffer_gl->b.flags &= ~(WINED3D_BUFFER_APPLESYNC | WINED3D_BUFFER_PERSISTENT);
+}
+
+static BOOL wined3d_buffer_gl_use_stream_bos(const struct wined3d_buffer_gl *buffer_gl,
+        const struct wined3d_gl_info *gl_info)
+{
+    const struct wined3d_resource *resource = &buffer_gl->b.resource;
+
+    /* Switching buffer objects on DISCARD maps requires the bindings to be
+     * reapplied. That's cheap for vertex, index and constant buffers, but
+     * views and transform feedback hold on to the buffer object. */
+    return resource->usage & WINED3DUSAGE_DYNAMIC
+            && !(resource->bind_flags & ~(WINED3D_BIND_VERTEX_BUFFER
+            | WINED3D_BIND_INDEX_BUFFER | WINED3D_BIND_CONSTANT_BUFFER))
+            && !(buffer_gl->b.flags & WINED3D_BUFFER_PIN_SYSMEM)
+            && gl_info->supported[ARB_BUFFER_STORAGE]
+            && gl_info->supported[ARB_MAP_BUFFER_RANGE]
+            && gl_info->supported[ARB_SYNC];
+}
+
+/* Context activation is done by the caller. */
+static BOOL wined3d_buffer_gl_create_stream_bo(struct wined3d_buffer_gl *buffer_gl,
+        struct wined3d_context *context, struct wined3d_buffer_gl_stream_bo *bo)
+{
+    GLbitfield map_flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const struct wined3d_gl_info *gl_info = context->gl_info;
+    GLenum error;
+
+    /* Read access may keep the driver from using write-combined memory. */
+    if (buffer_gl->b.resource.access & WINED3D_RESOURCE_ACCESS_MAP_R)
+        map_flags |= GL_MAP_READ_BIT;
+
+    while (gl_info->gl_ops.gl.p_glGetError() != GL_NO_ERROR);
+
+    GL_EXTCALL(glGenBuffers(1, &bo->name));
+    context_bind_bo(context, buffer_gl->buffer_type_hint, bo->name);
+    GL_EXTCALL(glBufferStorage(buffer_gl->buffer_type_hint, buffer_gl->b.resource.size,
+            NULL, map_flags | GL_DYNAMIC_STORAGE_BIT));
+    bo->ptr = GL_EXTCALL(glMapBufferRange(buffer_gl->buffer_type_hint,
+            0, buffer_gl->b.resource.size, map_flags));
+    bo->fence = NULL;
+
+    error = gl_info->gl_ops.gl.p_glGetError();
+    if (error != GL_NO_ERROR || !bo->ptr || ((DWORD_PTR)bo->ptr & (RESOURCE_ALIGNMENT - 1)))
+    {
+        WARN("Failed to create a persistently mapped BO, error %s (%#x), pointer %p.\n",
+                debug_glerror(error), error, bo->ptr);
+        GL_EXTCALL(glDeleteBuffers(1, &bo->name));
+        bo->name = 0;
+        bo->ptr = NULL;
+        return FALSE;
+    }
+
+    return TRUE;
 }
 
 /* Context activation is done by the caller. */
@@ -217,6 +292,21 @@ static BOOL wined3d_buffer_gl_create_buffer_object(struct wined3d_buffer_gl *buf
      * to be verified to check if the rhw and color values are in the correct
      * format. */
 
+    if (wined3d_buffer_gl_use_stream_bos(buffer_gl, gl_info))
+    {
+        if (wined3d_buffer_gl_create_stream_bo(buffer_gl, context, &buffer_gl->stream_bos[0]))
+        {
+            buffer_gl->stream_bo_count = 1;
+            buffer_gl->stream_bo_idx = 0;
+            buffer_gl->buffer_object = buffer_gl->stream_bos[0].name;
+            buffer_gl->buffer_object_usage = GL_STREAM_DRAW_ARB;
+            buffer_gl->b.flags |= WINED3D_BUFFER_PERSISTENT;
+            buffer_invalidate_bo_range(&buffer_gl->b, 0, 0);
+            return TRUE;
+        }
+        WARN("Falling back to a regular buffer object.\n");
+    }
+
     GL_EXTCALL(glGenBuffers(1, &buffer_gl->buffer_object));
     error = gl_info->gl_ops.gl.p_glGetError();
     if (!buffer_gl->buffer_object || error != GL_NO_ERROR)
@@ -1004,6 +1094,79 @@ struct wined3d_resource * CDECL wined3d_buffer_get_resource(struct wined3d_buffe
     return &buffer->resource;
 }
 
+/* Context activation is done by the caller. */
+static BYTE *wined3d_buffer_gl_map_stream_bo(struct wined3d_buffer_gl *buffer_gl,
+        struct wined3d_context *context, DWORD flags)
+{
+    struct wined3d_device *device = buffer_gl->b.resource.device;
+    const struct wined3d_gl_info *gl_info = context->gl_info;
+    struct wined3d_buffer_gl_stream_bo *bo;
+    unsigned int next_idx, i;
+    HRESULT hr;
+
+    bo = &buffer_gl->stream_bos[buffer_gl->stream_bo_idx];
+
+    /* The buffer objects are mapped coherently, so writes without DISCARD
+     * only need the pointer. Reads have to wait for the GPU. */
+    if (!(flags & WINED3D_MAP_DISCARD))
+    {
+        if (!(flags & WINED3D_MAP_WRITE))
+            gl_info->gl_ops.gl.p_glFinish();
+        return bo->ptr;
+    }
+
+    /* Retire the current buffer object. Draws using it have all been
+     * submitted by now, so a fence issued here covers them. */
+    if (!bo->fence && FAILED(hr = wined3d_fence_create(device, &bo->fence)))
+    {
+        ERR("Failed to create fence, hr %#x.\n", hr);
+        gl_info->gl_ops.gl.p_glFinish();
+        return bo->ptr;
+    }
+    wined3d_fence_issue(bo->fence, device);
+
+    next_idx = (buffer_gl->stream_bo_idx + 1) % buffer_gl->stream_bo_count;
+    if (wined3d_fence_test(buffer_gl->stream_bos[next_idx].fence, device, WINED3DGETDATA_FLUSH) != WINED3D_FENCE_OK)
+    {
+        /* The oldest buffer object is still in use. Grow the ring in front
+         * of it, so that buffer objects keep being reused in the order they
+         * were retired. */
+        if (buffer_gl->stream_bo_count < ARRAY_SIZE(buffer_gl->stream_bos))
+        {
+            next_idx = buffer_gl->stream_bo_idx + 1;
+            for (i = buffer_gl->stream_bo_count; i > next_idx; --i)
+                buffer_gl->stream_bos[i] = buffer_gl->stream_bos[i - 1];
+
+            if (wined3d_buffer_gl_create_stream_bo(buffer_gl, context, &buffer_gl->stream_bos[next_idx]))
+            {
+                TRACE_(d3d_perf)("Growing buffer %p to %u stream BOs.\n",
+                        buffer_gl, buffer_gl->stream_bo_count + 1);
+                ++buffer_gl->stream_bo_count;
+            }
+            else
+            {
+                for (i = next_idx; i < buffer_gl->stream_bo_count; ++i)
+                    buffer_gl->stream_bos[i] = buffer_gl->stream_bos[i + 1];
+                next_idx %= buffer_gl->stream_bo_count;
+            }
+        }
+
+        if (buffer_gl->stream_bos[next_idx].fence)
+        {
+            TRACE_(d3d_perf)("Waiting for stream BO %u of buffer %p.\n", next_idx, buffer_gl);
+            if (wined3d_fence_wait(buffer_gl->stream_bos[next_idx].fence, device) != WINED3D_FENCE_OK)
+                gl_info->gl_ops.gl.p_glFinish();
+        }
+    }
+
+    buffer_gl->stream_bo_idx = next_idx;
+    buffer_gl->buffer_object = buffer_gl->stream_bos[next_idx].name;
+    if (buffer_gl->b.resource.bind_count)
+        buffer_invalidate_bind_state(&buffer_gl->b.resource);
+
+    return buffer_gl->stream_bos[next_idx].ptr;
+}
+
 static HRESULT wined3d_buffer_gl_map(struct wined3d_buffer_gl *buffer_gl,
         unsigned int offset, unsigned int size, BYTE **data, DWORD flags)
 {
@@ -1076,7 +1239,11 @@ static HRESULT wined3d_buffer_gl_map(struct wined3d_buffer_gl *buffer_gl,
                 if (buffer_gl->b.flags & WINED3D_BUFFER_DISCARD)
                     flags &= ~WINED3D_MAP_DISCARD;
 
-                if (gl_info->supported[ARB_MAP_BUFFER_RANGE])
+                if (buffer_gl->b.flags & WINED3D_BUFFER_PERSISTENT)
+                {
+                    buffer_gl->b.map_ptr = wined3d_buffer_gl_map_stream_bo(buffer_gl, context, flags);
+                }
+                else if (gl_info->supported[ARB_MAP_BUFFER_RANGE])
                 {
                     GLbitfield mapflags = wined3d_resource_gl_map_flags(flags);
                     buffer_gl->b.map_ptr = GL_EXTCALL(glMapBufferRange(buffer_gl->buffer_type_hint,
@@ -1158,7 +1325,13 @@ static void wined3d_buffer_gl_unmap(struct wined3d_buffer_gl *buffer_gl)
         return;
     }
 
-    if (buffer_gl->b.map_ptr)
+    if (buffer_gl->b.map_ptr && buffer_gl->b.flags & WINED3D_BUFFER_PERSISTENT)
+    {
+        /* Stream buffer objects stay mapped, and writes to them are coherent. */
+        buffer_clear_dirty_areas(&buffer_gl->b);
+        buffer_gl->b.map_ptr = NULL;
+    }
+    else if (buffer_gl->b.map_ptr)
     {
         struct wined3d_device *device = buffer_gl->b.resource.device;
         const struct wined3d_gl_info *gl_info;
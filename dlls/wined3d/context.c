@@ -2281,6 +2281,8 @@ BOOL wined3d_adapter_gl_create_context(struct wined3d_context *context,
         gl_info->gl_ops.gl.p_glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
         checkGLcall("enable seamless cube map filtering");
     }
+    if (gl_info->supported[ARB_PARALLEL_SHADER_COMPILE])
+        GL_EXTCALL(glMaxShaderCompilerThreadsARB(~0u));
     if (gl_info->supported[ARB_CLIP_CONTROL])
         GL_EXTCALL(glPointParameteri(GL_POINT_SPRITE_COORD_ORIGIN, GL_LOWER_LEFT));
 
@@ -50,9 +50,7 @@ enum wined3d_cs_op
     WINED3D_CS_OP_SET_SHADER,
     WINED3D_CS_OP_SET_BLEND_STATE,
     WINED3D_CS_OP_SET_RASTERIZER_STATE,
-    WINED3D_CS_OP_SET_RENDER_STATE,
-    WINED3D_CS_OP_SET_TEXTURE_STATE,
-    WINED3D_CS_OP_SET_SAMPLER_STATE,
+    WINED3D_CS_OP_SET_STATES,
     WINED3D_CS_OP_SET_TRANSFORM,
     WINED3D_CS_OP_SET_CLIP_PLANE,
     WINED3D_CS_OP_SET_COLOR_KEY,
@@ -273,27 +271,26 @@ struct wined3d_cs_set_rasterizer_state
     struct wined3d_rasterizer_state *state;
 };
 
-struct wined3d_cs_set_render_state
+enum wined3d_cs_state_type
 {
-    enum wined3d_cs_op opcode;
-    enum wined3d_render_state state;
-    DWORD value;
+    WINED3D_CS_STATE_RENDER,
+    WINED3D_CS_STATE_TEXTURE,
+    WINED3D_CS_STATE_SAMPLER,
 };
 
-struct wined3d_cs_set_texture_state
+struct wined3d_cs_state_change
 {
-    enum wined3d_cs_op opcode;
-    UINT stage;
-    enum wined3d_texture_stage_state state;
+    enum wined3d_cs_state_type type;
+    unsigned int idx;
+    unsigned int state;
     DWORD value;
 };
 
-struct wined3d_cs_set_sampler_state
+struct wined3d_cs_set_states
 {
     enum wined3d_cs_op opcode;
-    UINT sampler_idx;
-    enum wined3d_sampler_state state;
-    DWORD value;
+    unsigned int count;
+    struct wined3d_cs_state_change changes[1];
 };
 
 struct wined3d_cs_set_transform
@@ -447,6 +444,8 @@ struct wined3d_cs_stop
 static inline void *wined3d_cs_require_space(struct wined3d_cs *cs,
         size_t size, enum wined3d_cs_queue_id queue_id)
 {
+    if (queue_id == WINED3D_CS_QUEUE_DEFAULT && cs->state_batch.count)
+        wined3d_cs_flush_states(cs);
     return cs->ops->require_space(cs, size, queue_id);
 }
 
@@ -484,9 +483,7 @@ static const char *debug_cs_op(enum wined3d_cs_op op)
         WINED3D_TO_STR(WINED3D_CS_OP_SET_SHADER);
         WINED3D_TO_STR(WINED3D_CS_OP_SET_BLEND_STATE);
         WINED3D_TO_STR(WINED3D_CS_OP_SET_RASTERIZER_STATE);
-        WINED3D_TO_STR(WINED3D_CS_OP_SET_RENDER_STATE);
-        WINED3D_TO_STR(WINED3D_CS_OP_SET_TEXTURE_STATE);
-        WINED3D_TO_STR(WINED3D_CS_OP_SET_SAMPLER_STATE);
+        WINED3D_TO_STR(WINED3D_CS_OP_SET_STATES);
         WINED3D_TO_STR(WINED3D_CS_OP_SET_TRANSFORM);
         WINED3D_TO_STR(WINED3D_CS_OP_SET_CLIP_PLANE);
         WINED3D_TO_STR(WINED3D_CS_OP_SET_COLOR_KEY);
@@ -1614,68 +1611,136 @@ void wined3d_cs_emit_set_rasterizer_state(struct wined3d_cs *cs,
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
 }
 
-static void wined3d_cs_exec_set_render_state(struct wined3d_cs *cs, const void *data)
+static void wined3d_cs_exec_set_states(struct wined3d_cs *cs, const void *data)
 {
-    const struct wined3d_cs_set_render_state *op = data;
+    const struct wined3d_cs_set_states *op = data;
+    const struct wined3d_cs_state_change *change;
+    unsigned int i;
 
-    cs->state.render_states[op->state] = op->value;
-    device_invalidate_state(cs->device, STATE_RENDER(op->state));
+    for (i = 0; i < op->count; ++i)
+    {
+        change = &op->changes[i];
+        switch (change->type)
+        {
+            case WINED3D_CS_STATE_RENDER:
+                cs->state.render_states[change->state] = change->value;
+                device_invalidate_state(cs->device, STATE_RENDER(change->state));
+                break;
+
+            case WINED3D_CS_STATE_TEXTURE:
+                cs->state.texture_states[change->idx][change->state] = change->value;
+                device_invalidate_state(cs->device, STATE_TEXTURESTAGE(change->idx, change->state));
+                break;
+
+            case WINED3D_CS_STATE_SAMPLER:
+                cs->state.sampler_states[change->idx][change->state] = change->value;
+                device_invalidate_state(cs->device, STATE_SAMPLER(change->idx));
+                break;
+        }
+    }
 }
 
-void wined3d_cs_emit_set_render_state(struct wined3d_cs *cs, enum wined3d_render_state state, DWORD value)
+static void wined3d_cs_add_state_change(struct wined3d_cs_state_change **change,
+        enum wined3d_cs_state_type type, unsigned int idx, unsigned int state, DWORD value)
 {
-    struct wined3d_cs_set_render_state *op;
+    (*change)->type = type;
+    (*change)->idx = idx;
+    (*change)->state = state;
+    (*change)->value = value;
+    ++*change;
+}
 
-    op = wined3d_cs_require_space(cs, sizeof(*op), WINED3D_CS_QUEUE_DEFAULT);
-    op->opcode = WINED3D_CS_OP_SET_RENDER_STATE;
-    op->state = state;
-    op->value = value;
+/* Render, texture stage and sampler states are batched on the application
+ * side, and submitted as a single packet before the next command that could
+ * depend on them. A state set several times in between is only sent once. */
+void wined3d_cs_flush_states(struct wined3d_cs *cs)
+{
+    struct wined3d_cs_state_batch *batch = &cs->state_batch;
+    struct wined3d_cs_state_change *change;
+    struct wined3d_cs_set_states *op;
+    unsigned int i, j, count;
+    DWORD map;
+
+    /* Only the application thread batches states. */
+    if (!(count = batch->count) || cs->thread_id == GetCurrentThreadId())
+        return;
+    batch->count = 0;
+
+    op = wined3d_cs_require_space(cs, FIELD_OFFSET(struct wined3d_cs_set_states, changes[count]),
+            WINED3D_CS_QUEUE_DEFAULT);
+    op->opcode = WINED3D_CS_OP_SET_STATES;
+    op->count = count;
+    change = op->changes;
+
+    for (i = 0; i < ARRAY_SIZE(batch->render_state_mask); ++i)
+    {
+        for (map = batch->render_state_mask[i]; map;)
+        {
+            j = i * 32 + wined3d_bit_scan(&map);
+            wined3d_cs_add_state_change(&change, WINED3D_CS_STATE_RENDER, 0, j, batch->render_states[j]);
+        }
+        batch->render_state_mask[i] = 0;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(batch->texture_state_mask); ++i)
+    {
+        for (map = batch->texture_state_mask[i]; map;)
+        {
+            j = wined3d_bit_scan(&map);
+            wined3d_cs_add_state_change(&change, WINED3D_CS_STATE_TEXTURE, i, j, batch->texture_states[i][j]);
+        }
+        batch->texture_state_mask[i] = 0;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(batch->sampler_state_mask); ++i)
+    {
+        for (map = batch->sampler_state_mask[i]; map;)
+        {
+            j = wined3d_bit_scan(&map);
+            wined3d_cs_add_state_change(&change, WINED3D_CS_STATE_SAMPLER, i, j, batch->sampler_states[i][j]);
+        }
+        batch->sampler_state_mask[i] = 0;
+    }
 
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
 }
 
-static void wined3d_cs_exec_set_texture_state(struct wined3d_cs *cs, const void *data)
+void wined3d_cs_emit_set_render_state(struct wined3d_cs *cs, enum wined3d_render_state state, DWORD value)
 {
-    const struct wined3d_cs_set_texture_state *op = data;
+    struct wined3d_cs_state_batch *batch = &cs->state_batch;
 
-    cs->state.texture_states[op->stage][op->state] = op->value;
-    device_invalidate_state(cs->device, STATE_TEXTURESTAGE(op->stage, op->state));
+    if (!(batch->render_state_mask[state >> 5] & (1u << (state & 0x1f))))
+    {
+        batch->render_state_mask[state >> 5] |= 1u << (state & 0x1f);
+        ++batch->count;
+    }
+    batch->render_states[state] = value;
 }
 
 void wined3d_cs_emit_set_texture_state(struct wined3d_cs *cs, UINT stage,
         enum wined3d_texture_stage_state state, DWORD value)
 {
-    struct wined3d_cs_set_texture_state *op;
+    struct wined3d_cs_state_batch *batch = &cs->state_batch;
 
-    op = wined3d_cs_require_space(cs, sizeof(*op), WINED3D_CS_QUEUE_DEFAULT);
-    op->opcode = WINED3D_CS_OP_SET_TEXTURE_STATE;
-    op->stage = stage;
-    op->state = state;
-    op->value = value;
-
-    wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
-}
-
-static void wined3d_cs_exec_set_sampler_state(struct wined3d_cs *cs, const void *data)
-{
-    const struct wined3d_cs_set_sampler_state *op = data;
-
-    cs->state.sampler_states[op->sampler_idx][op->state] = op->value;
-    device_invalidate_state(cs->device, STATE_SAMPLER(op->sampler_idx));
+    if (!(batch->texture_state_mask[stage] & (1u << state)))
+    {
+        batch->texture_state_mask[stage] |= 1u << state;
+        ++batch->count;
+    }
+    batch->texture_states[stage][state] = value;
 }
 
 void wined3d_cs_emit_set_sampler_state(struct wined3d_cs *cs, UINT sampler_idx,
         enum wined3d_sampler_state state, DWORD value)
 {
-    struct wined3d_cs_set_sampler_state *op;
+    struct wined3d_cs_state_batch *batch = &cs->state_batch;
 
-    op = wined3d_cs_require_space(cs, sizeof(*op), WINED3D_CS_QUEUE_DEFAULT);
-    op->opcode = WINED3D_CS_OP_SET_SAMPLER_STATE;
-    op->sampler_idx = sampler_idx;
-    op->state = state;
-    op->value = value;
-
-    wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
+    if (!(batch->sampler_state_mask[sampler_idx] & (1u << state)))
+    {
+        batch->sampler_state_mask[sampler_idx] |= 1u << state;
+        ++batch->count;
+    }
+    batch->sampler_states[sampler_idx][state] = value;
 }
 
 static void wined3d_cs_exec_set_transform(struct wined3d_cs *cs, const void *data)
@@ -2545,9 +2610,7 @@ static void (* const wined3d_cs_op_handlers[])(struct wined3d_cs *cs, const void
     /* WINED3D_CS_OP_SET_SHADER                  */ wined3d_cs_exec_set_shader,
     /* WINED3D_CS_OP_SET_BLEND_STATE             */ wined3d_cs_exec_set_blend_state,
     /* WINED3D_CS_OP_SET_RASTERIZER_STATE        */ wined3d_cs_exec_set_rasterizer_state,
-    /* WINED3D_CS_OP_SET_RENDER_STATE            */ wined3d_cs_exec_set_render_state,
-    /* WINED3D_CS_OP_SET_TEXTURE_STATE           */ wined3d_cs_exec_set_texture_state,
-    /* WINED3D_CS_OP_SET_SAMPLER_STATE           */ wined3d_cs_exec_set_sampler_state,
+    /* WINED3D_CS_OP_SET_STATES                  */ wined3d_cs_exec_set_states,
     /* WINED3D_CS_OP_SET_TRANSFORM               */ wined3d_cs_exec_set_transform,
     /* WINED3D_CS_OP_SET_CLIP_PLANE              */ wined3d_cs_exec_set_clip_plane,
     /* WINED3D_CS_OP_SET_COLOR_KEY               */ wined3d_cs_exec_set_color_key,
@@ -2710,6 +2773,7 @@ static void *wined3d_cs_queue_require_space(struct wined3d_cs_queue *queue, size
 
         TRACE("Waiting for free space. Head %u, tail %u, packet size %lu.\n",
                 head, tail, (unsigned long)packet_size);
+        wined3d_pause();
     }
 
     packet = (struct wined3d_cs_packet *)&queue->data[queue->head];
@@ -2778,6 +2842,7 @@ static void wined3d_cs_wait_event(struct wined3d_cs *cs)
 
 static DWORD WINAPI wined3d_cs_run(void *ctx)
 {
+    unsigned int spin_limit = WINED3D_CS_SPIN_COUNT;
     struct wined3d_cs_packet *packet;
     struct wined3d_cs_queue *queue;
     unsigned int spin_count = 0;
@@ -2809,11 +2874,20 @@ static DWORD WINAPI wined3d_cs_run(void *ctx)
             queue = &cs->queue[WINED3D_CS_QUEUE_DEFAULT];
             if (wined3d_cs_queue_is_empty(cs, queue))
             {
-                if (++spin_count >= WINED3D_CS_SPIN_COUNT && list_empty(&cs->query_poll_list))
+                if (++spin_count >= spin_limit && list_empty(&cs->query_poll_list))
+                {
+                    /* Spinning didn't pay off; spin for a shorter time
+                     * before blocking next time. */
+                    spin_limit = max(spin_limit / 2, WINED3D_CS_SPIN_COUNT_MIN);
                     wined3d_cs_wait_event(cs);
+                    spin_count = 0;
+                }
                 continue;
             }
         }
+        /* New commands arrived late in the spin; spin for longer next time. */
+        if (spin_count > spin_limit / 2 && spin_count < spin_limit)
+            spin_limit = min(spin_limit * 2, WINED3D_CS_SPIN_COUNT);
         spin_count = 0;
 
         tail = queue->tail;
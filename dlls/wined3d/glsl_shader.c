@@ -39,9 +39,11 @@
 #endif
 
 #include "wined3d_private.h"
+#include "wine/library.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d_shader);
 WINE_DECLARE_DEBUG_CHANNEL(d3d);
+WINE_DECLARE_DEBUG_CHANNEL(d3d_perf);
 WINE_DECLARE_DEBUG_CHANNEL(winediag);
 
 #define WINED3D_GLSL_SAMPLE_PROJECTED   0x01
@@ -127,6 +129,20 @@ struct constant_heap
     unsigned int size;
 };
 
+struct glsl_shader_cache
+{
+    char *path;
+    UINT64 driver_key;
+    UINT64 size;
+    UINT64 max_size;
+
+    unsigned int source_hits;
+    unsigned int source_misses;
+    unsigned int program_hits;
+    unsigned int program_misses;
+    unsigned int program_rejects;
+};
+
 /* GLSL shader private data */
 struct shader_glsl_priv
 {
@@ -144,6 +160,8 @@ struct shader_glsl_priv
     struct wine_rb_tree ffp_fragment_shaders;
     BOOL ffp_proj_control;
     BOOL legacy_lighting;
+
+    struct glsl_shader_cache shader_cache;
 };
 
 struct glsl_vs_program
@@ -333,6 +351,8 @@ struct glsl_shader_private
         struct glsl_cs_compiled_shader *cs;
     } gl_shaders;
     unsigned int num_gl_shaders, shader_array_size;
+    /* The variant compiled by shader_glsl_precompile(), until a draw uses it. */
+    GLuint precompiled_id;
 };
 
 struct glsl_ffp_vertex_shader
@@ -531,7 +551,10 @@ static void shader_glsl_compile(const struct wined3d_gl_info *gl_info, GLuint sh
     checkGLcall("glShaderSource");
     GL_EXTCALL(glCompileShader(shader));
     checkGLcall("glCompileShader");
-    print_glsl_info_log(gl_info, shader, FALSE);
+    /* Querying the info log would wait for a background compile to finish.
+     * Compile errors are still reported if linking the program fails. */
+    if (!gl_info->supported[ARB_PARALLEL_SHADER_COMPILE])
+        print_glsl_info_log(gl_info, shader, FALSE);
 }
 
 /* Context activation is done by the caller. */
@@ -575,6 +598,8 @@ static void shader_glsl_dump_program_source(const struct wined3d_gl_info *gl_inf
         GL_EXTCALL(glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &tmp));
         FIXME("    GL_COMPILE_STATUS: %d.\n", tmp);
         FIXME("\n");
+        if (gl_info->supported[ARB_PARALLEL_SHADER_COMPILE])
+            print_glsl_info_log(gl_info, shaders[i], FALSE);
 
         ptr = source;
         GL_EXTCALL(glGetShaderSource(shaders[i], source_size, NULL, source));
@@ -604,6 +629,436 @@ void shader_glsl_validate_link(const struct wined3d_gl_info *gl_info, GLuint pro
     print_glsl_info_log(gl_info, program, TRUE);
 }
 
+/* The persistent shader cache stores the GLSL source generated for a shader
+ * variant, keyed on the shader byte code and compile arguments, and linked
+ * program binaries, keyed on the sources of the attached shaders. Every key
+ * includes the Wine build and the GL driver, so stale entries are simply
+ * never looked up again. */
+#define WINED3D_GLSL_CACHE_MAGIC    0x43534777 /* "wGSC" */
+#define WINED3D_GLSL_CACHE_VERSION  1
+
+struct glsl_shader_cache_header
+{
+    UINT64 key;
+    DWORD magic;
+    DWORD version;
+    DWORD format;
+    DWORD extra_size;
+    DWORD data_size;
+    DWORD padding;
+};
+
+static UINT64 shader_glsl_cache_hash(UINT64 hash, const void *data, SIZE_T size)
+{
+    const BYTE *ptr = data;
+
+    /* 64-bit FNV-1a. */
+    while (size--)
+        hash = (hash ^ *ptr++) * 0x100000001b3;
+    return hash;
+}
+
+struct glsl_shader_cache_entry
+{
+    FILETIME time;
+    UINT64 size;
+    char name[MAX_PATH];
+};
+
+static int glsl_shader_cache_entry_compare(const void *a, const void *b)
+{
+    const struct glsl_shader_cache_entry *e1 = a, *e2 = b;
+
+    return CompareFileTime(&e1->time, &e2->time);
+}
+
+/* Recomputes the size of the cache directory and, if it exceeds the limit,
+ * deletes the least recently written entries until the cache is back to 3/4
+ * of the limit. The directory may be shared with other processes, so the
+ * size tracked by the stores is only an estimate. */
+static void shader_glsl_cache_trim(struct glsl_shader_cache *cache)
+{
+    struct glsl_shader_cache_entry *entries = NULL, *new_entries;
+    SIZE_T count = 0, capacity = 0, i;
+    WIN32_FIND_DATAA data;
+    char *pattern, *name;
+    UINT64 size = 0;
+    HANDLE find;
+
+    if (!(pattern = heap_alloc(strlen(cache->path) + 3)))
+        return;
+    sprintf(pattern, "%s\\*", cache->path);
+    find = FindFirstFileA(pattern, &data);
+    heap_free(pattern);
+    if (find == INVALID_HANDLE_VALUE)
+        return;
+
+    do
+    {
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            continue;
+        if (count == capacity)
+        {
+            capacity = max(capacity * 2, 64);
+            if (!(new_entries = heap_realloc(entries, capacity * sizeof(*entries))))
+                break;
+            entries = new_entries;
+        }
+        entries[count].time = data.ftLastWriteTime;
+        entries[count].size = (UINT64)data.nFileSizeHigh << 32 | data.nFileSizeLow;
+        strcpy(entries[count].name, data.cFileName);
+        size += entries[count++].size;
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+
+    if (size > cache->max_size && (name = heap_alloc(strlen(cache->path) + MAX_PATH + 1)))
+    {
+        qsort(entries, count, sizeof(*entries), glsl_shader_cache_entry_compare);
+        for (i = 0; i < count && size > cache->max_size / 4 * 3; ++i)
+        {
+            sprintf(name, "%s\\%s", cache->path, entries[i].name);
+            if (DeleteFileA(name))
+                size -= entries[i].size;
+        }
+        TRACE("Evicted %lu shader cache entries.\n", (unsigned long)i);
+        heap_free(name);
+    }
+    heap_free(entries);
+
+    cache->size = size;
+}
+
+static void shader_glsl_cache_init(struct glsl_shader_cache *cache)
+{
+    DWORD len;
+    char *path;
+
+    if (!wined3d_settings.shader_cache || !wined3d_settings.shader_cache_path)
+        return;
+
+    len = strlen(wined3d_settings.shader_cache_path) + 1;
+    if (!(path = heap_alloc(len)))
+        return;
+    memcpy(path, wined3d_settings.shader_cache_path, len);
+
+    if (!CreateDirectoryA(path, NULL) && GetLastError() != ERROR_ALREADY_EXISTS)
+    {
+        WARN("Failed to create shader cache directory %s, error %u.\n", debugstr_a(path), GetLastError());
+        heap_free(path);
+        return;
+    }
+
+    TRACE("Using shader cache directory %s.\n", debugstr_a(path));
+    cache->path = path;
+    cache->max_size = (UINT64)wined3d_settings.shader_cache_size << 20;
+    shader_glsl_cache_trim(cache);
+}
+
+static void shader_glsl_cache_cleanup(struct glsl_shader_cache *cache)
+{
+    if (!cache->path)
+        return;
+
+    TRACE_(d3d_perf)("Shader cache statistics: sources %u hits, %u misses; "
+            "programs %u hits, %u misses, %u rejected.\n",
+            cache->source_hits, cache->source_misses,
+            cache->program_hits, cache->program_misses, cache->program_rejects);
+    heap_free(cache->path);
+}
+
+/* Context activation is done by the caller. */
+static UINT64 shader_glsl_cache_get_driver_key(struct glsl_shader_cache *cache,
+        const struct wined3d_context *context)
+{
+    static const GLenum names[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+    const struct wined3d_d3d_info *d3d_info = context->d3d_info;
+    const struct wined3d_gl_info *gl_info = context->gl_info;
+    const char *build_id = wine_get_build_id();
+    DWORD version = WINED3D_GLSL_CACHE_VERSION;
+    DWORD d3d_flags;
+    const char *str;
+    unsigned int i;
+    UINT64 key;
+
+    if (cache->driver_key)
+        return cache->driver_key;
+
+    key = shader_glsl_cache_hash(0xcbf29ce484222325, &version, sizeof(version));
+    key = shader_glsl_cache_hash(key, build_id, strlen(build_id));
+    for (i = 0; i < ARRAY_SIZE(names); ++i)
+    {
+        if ((str = (const char *)gl_info->gl_ops.gl.p_glGetString(names[i])))
+            key = shader_glsl_cache_hash(key, str, strlen(str));
+    }
+    key = shader_glsl_cache_hash(key, gl_info->supported, sizeof(gl_info->supported));
+    key = shader_glsl_cache_hash(key, &gl_info->limits, sizeof(gl_info->limits));
+    key = shader_glsl_cache_hash(key, &gl_info->glsl_version, sizeof(gl_info->glsl_version));
+    key = shader_glsl_cache_hash(key, &gl_info->quirks, sizeof(gl_info->quirks));
+    key = shader_glsl_cache_hash(key, &wined3d_settings.check_float_constants,
+            sizeof(wined3d_settings.check_float_constants));
+
+    /* The generated code also depends on the adapter capabilities and the
+     * device creation flags, e.g. WINED3D_PIXEL_CENTER_INTEGER. The
+     * ffp_attrib_ops are function pointers and don't affect the shaders. */
+    key = shader_glsl_cache_hash(key, &d3d_info->limits, sizeof(d3d_info->limits));
+    key = shader_glsl_cache_hash(key, &d3d_info->valid_rt_mask, sizeof(d3d_info->valid_rt_mask));
+    key = shader_glsl_cache_hash(key, &d3d_info->wined3d_creation_flags, sizeof(d3d_info->wined3d_creation_flags));
+    d3d_flags = d3d_info->xyzrhw
+            | d3d_info->emulated_flatshading << 1
+            | d3d_info->ffp_generic_attributes << 2
+            | d3d_info->vs_clipping << 3
+            | d3d_info->shader_color_key << 4
+            | d3d_info->shader_double_precision << 5
+            | d3d_info->viewport_array_index_any_shader << 6
+            | d3d_info->texture_npot << 7
+            | d3d_info->texture_npot_conditional << 8;
+    key = shader_glsl_cache_hash(key, &d3d_flags, sizeof(d3d_flags));
+    key = shader_glsl_cache_hash(key, &d3d_info->feature_level, sizeof(d3d_info->feature_level));
+
+    return cache->driver_key = key;
+}
+
+static char *shader_glsl_cache_get_file_name(const struct glsl_shader_cache *cache, UINT64 key, const char *ext)
+{
+    char *name;
+
+    if (!(name = heap_alloc(strlen(cache->path) + strlen(ext) + 19)))
+        return NULL;
+    sprintf(name, "%s\\%08x%08x.%s", cache->path, (unsigned int)(key >> 32), (unsigned int)key, ext);
+
+    return name;
+}
+
+/* Returns the entry data, followed by a terminating null byte. */
+static void *shader_glsl_cache_load(const struct glsl_shader_cache *cache, UINT64 key, const char *ext,
+        DWORD *format, void *extra, DWORD extra_size, DWORD *data_size)
+{
+    struct glsl_shader_cache_header header;
+    DWORD file_size, size;
+    char *name, *data = NULL;
+    HANDLE file;
+
+    if (!(name = shader_glsl_cache_get_file_name(cache, key, ext)))
+        return NULL;
+    file = CreateFileA(name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        heap_free(name);
+        return NULL;
+    }
+
+    file_size = GetFileSize(file, NULL);
+    if (ReadFile(file, &header, sizeof(header), &size, NULL) && size == sizeof(header)
+            && header.magic == WINED3D_GLSL_CACHE_MAGIC && header.version == WINED3D_GLSL_CACHE_VERSION
+            && header.key == key && header.extra_size == extra_size && header.data_size < file_size
+            && file_size == sizeof(header) + extra_size + header.data_size
+            && (data = heap_alloc(header.data_size + 1)))
+    {
+        if ((extra_size && (!ReadFile(file, extra, extra_size, &size, NULL) || size != extra_size))
+                || !ReadFile(file, data, header.data_size, &size, NULL) || size != header.data_size)
+        {
+            heap_free(data);
+            data = NULL;
+        }
+        else
+        {
+            data[header.data_size] = 0;
+            *format = header.format;
+            *data_size = header.data_size;
+        }
+    }
+    CloseHandle(file);
+
+    if (!data)
+        WARN("Ignoring invalid shader cache entry %s.\n", debugstr_a(name));
+    heap_free(name);
+
+    return data;
+}
+
+static void shader_glsl_cache_store(struct glsl_shader_cache *cache, UINT64 key, const char *ext,
+        DWORD format, const void *extra, DWORD extra_size, const void *data, DWORD data_size)
+{
+    struct glsl_shader_cache_header header;
+    HANDLE file;
+    char *name;
+    DWORD size;
+
+    if (!(name = shader_glsl_cache_get_file_name(cache, key, ext)))
+        return;
+
+    /* Fails if another process is accessing the same entry; it will write the
+     * same data anyway. */
+    file = CreateFileA(name, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        heap_free(name);
+        return;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.key = key;
+    header.magic = WINED3D_GLSL_CACHE_MAGIC;
+    header.version = WINED3D_GLSL_CACHE_VERSION;
+    header.format = format;
+    header.extra_size = extra_size;
+    header.data_size = data_size;
+
+    if (!WriteFile(file, &header, sizeof(header), &size, NULL) || size != sizeof(header)
+            || (extra_size && (!WriteFile(file, extra, extra_size, &size, NULL) || size != extra_size))
+            || !WriteFile(file, data, data_size, &size, NULL) || size != data_size)
+    {
+        WARN("Failed to write shader cache entry %s, error %u.\n", debugstr_a(name), GetLastError());
+        CloseHandle(file);
+        DeleteFileA(name);
+    }
+    else
+    {
+        CloseHandle(file);
+        cache->size += sizeof(header) + extra_size + data_size;
+    }
+    heap_free(name);
+
+    if (cache->size > cache->max_size)
+        shader_glsl_cache_trim(cache);
+}
+
+/* Context activation is done by the caller. */
+static UINT64 shader_glsl_cache_get_shader_key(struct glsl_shader_cache *cache,
+        const struct wined3d_context *context, const struct wined3d_shader *shader,
+        const void *args, SIZE_T args_size)
+{
+    const struct wined3d_shader_version *version = &shader->reg_maps.shader_version;
+    UINT64 key;
+
+    key = shader_glsl_cache_get_driver_key(cache, context);
+    key = shader_glsl_cache_hash(key, &version->type, sizeof(version->type));
+    key = shader_glsl_cache_hash(key, shader->byte_code, shader->byte_code_size);
+    key = shader_glsl_cache_hash(key, shader->limits, sizeof(*shader->limits));
+
+    return shader_glsl_cache_hash(key, args, args_size);
+}
+
+static BOOL shader_glsl_cache_load_source(struct glsl_shader_cache *cache, UINT64 key,
+        struct wined3d_string_buffer *buffer, void *extra, DWORD extra_size)
+{
+    DWORD format, size;
+    char *source;
+
+    if (!(source = shader_glsl_cache_load(cache, key, "glsl", &format, extra, extra_size, &size)))
+    {
+        ++cache->source_misses;
+        return FALSE;
+    }
+
+    TRACE("Using cached GLSL source for key %s.\n", wine_dbgstr_longlong(key));
+    ++cache->source_hits;
+    shader_addline(buffer, "%s", source);
+    heap_free(source);
+
+    return TRUE;
+}
+
+static void shader_glsl_cache_store_source(struct glsl_shader_cache *cache, UINT64 key,
+        const struct wined3d_string_buffer *buffer, const void *extra, DWORD extra_size)
+{
+    shader_glsl_cache_store(cache, key, "glsl", 0, extra, extra_size, buffer->buffer, buffer->content_size);
+}
+
+/* Context activation is done by the caller. */
+static UINT64 shader_glsl_cache_get_program_key(struct glsl_shader_cache *cache,
+        const struct wined3d_context *context, GLuint program_id)
+{
+    const struct wined3d_gl_info *gl_info = context->gl_info;
+    GLint i, length, shader_count, source_size = 0;
+    UINT64 key, sources_key = 0;
+    char *source = NULL;
+    GLuint *shaders;
+
+    GL_EXTCALL(glGetProgramiv(program_id, GL_ATTACHED_SHADERS, &shader_count));
+    if (!(shaders = heap_calloc(shader_count, sizeof(*shaders))))
+        return 0;
+    GL_EXTCALL(glGetAttachedShaders(program_id, shader_count, NULL, shaders));
+
+    for (i = 0; i < shader_count; ++i)
+    {
+        GL_EXTCALL(glGetShaderiv(shaders[i], GL_SHADER_SOURCE_LENGTH, &length));
+        if (length > source_size)
+        {
+            heap_free(source);
+            if (!(source = heap_alloc(length)))
+            {
+                heap_free(shaders);
+                return 0;
+            }
+            source_size = length;
+        }
+        if (!length)
+            continue;
+
+        GL_EXTCALL(glGetShaderSource(shaders[i], source_size, &length, source));
+        /* The attachment order isn't defined, so combine the per-shader keys
+         * in an order independent way. */
+        sources_key += shader_glsl_cache_hash(0xcbf29ce484222325, source, length);
+    }
+    checkGLcall("get program sources");
+    heap_free(source);
+    heap_free(shaders);
+
+    key = shader_glsl_cache_get_driver_key(cache, context);
+    return shader_glsl_cache_hash(key, &sources_key, sizeof(sources_key));
+}
+
+/* Context activation is done by the caller. */
+static BOOL shader_glsl_cache_load_program(struct glsl_shader_cache *cache,
+        const struct wined3d_gl_info *gl_info, GLuint program_id, UINT64 key)
+{
+    DWORD format, size;
+    GLint status;
+    void *binary;
+
+    if (!(binary = shader_glsl_cache_load(cache, key, "bin", &format, NULL, 0, &size)))
+    {
+        ++cache->program_misses;
+        return FALSE;
+    }
+
+    GL_EXTCALL(glProgramBinary(program_id, format, binary, size));
+    heap_free(binary);
+    GL_EXTCALL(glGetProgramiv(program_id, GL_LINK_STATUS, &status));
+    checkGLcall("glProgramBinary");
+    if (!status)
+    {
+        TRACE("Cached binary for program %u was rejected.\n", program_id);
+        ++cache->program_rejects;
+        return FALSE;
+    }
+
+    TRACE("Using cached binary for program %u.\n", program_id);
+    ++cache->program_hits;
+    return TRUE;
+}
+
+/* Context activation is done by the caller. */
+static void shader_glsl_cache_store_program(struct glsl_shader_cache *cache,
+        const struct wined3d_gl_info *gl_info, GLuint program_id, UINT64 key)
+{
+    GLint status, length;
+    GLenum format;
+    void *binary;
+
+    GL_EXTCALL(glGetProgramiv(program_id, GL_LINK_STATUS, &status));
+    GL_EXTCALL(glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (!status || length <= 0 || !(binary = heap_alloc(length)))
+        return;
+
+    GL_EXTCALL(glGetProgramBinary(program_id, length, &length, &format, binary));
+    checkGLcall("glGetProgramBinary");
+    if (length > 0)
+        shader_glsl_cache_store(cache, key, "bin", format, NULL, 0, binary, length);
+    heap_free(binary);
+}
+
 static BOOL shader_glsl_use_layout_qualifier(const struct wined3d_gl_info *gl_info)
 {
     /* Layout qualifiers were introduced in GLSL 1.40. The Nvidia Legacy GPU
@@ -8629,14 +9084,17 @@ static GLuint shader_glsl_generate_compute_shader(const struct wined3d_context *
     return shader_id;
 }
 
-static GLuint find_glsl_pshader(const struct wined3d_context *context,
-        struct wined3d_string_buffer *buffer, struct wined3d_string_buffer_list *string_buffers,
+static GLuint find_glsl_pshader(const struct wined3d_context *context, struct shader_glsl_priv *priv,
         struct wined3d_shader *shader,
         const struct ps_compile_args *args, const struct ps_np2fixup_info **np2fixup_info)
 {
+    struct glsl_shader_cache *cache = &priv->shader_cache;
+    struct wined3d_string_buffer *buffer = &priv->shader_buffer;
+    const struct wined3d_gl_info *gl_info = context->gl_info;
     struct glsl_ps_compiled_shader *gl_shaders, *new_array;
     struct glsl_shader_private *shader_data;
     struct ps_np2fixup_info *np2fixup;
+    UINT64 cache_key = 0;
     UINT i;
     DWORD new_size;
     GLuint ret;
@@ -8662,11 +9120,26 @@ static GLuint find_glsl_pshader(const struct wined3d_context *context,
         {
             if (args->np2_fixup)
                 *np2fixup_info = &gl_shaders[i].np2fixup;
+            shader_data->precompiled_id = 0;
             return gl_shaders[i].id;
         }
     }
 
     TRACE("No matching GL shader found for shader %p, compiling a new shader.\n", shader);
+
+    /* The prediction made when the shader was created was wrong. The
+     * variant isn't attached to any program yet, so just delete it. */
+    for (i = 0; shader_data->precompiled_id && i < shader_data->num_gl_shaders; ++i)
+    {
+        if (gl_shaders[i].id != shader_data->precompiled_id)
+            continue;
+        TRACE("Deleting unused precompiled GL shader %u.\n", gl_shaders[i].id);
+        GL_EXTCALL(glDeleteShader(gl_shaders[i].id));
+        checkGLcall("glDeleteShader");
+        --shader_data->num_gl_shaders;
+        memmove(&gl_shaders[i], &gl_shaders[i + 1], (shader_data->num_gl_shaders - i) * sizeof(*gl_shaders));
+        shader_data->precompiled_id = 0;
+    }
     if (shader_data->shader_array_size == shader_data->num_gl_shaders)
     {
         if (shader_data->num_gl_shaders)
@@ -8698,7 +9171,22 @@ static GLuint find_glsl_pshader(const struct wined3d_context *context,
     pixelshader_update_resource_types(shader, args->tex_types);
 
     string_buffer_clear(buffer);
-    ret = shader_glsl_generate_pshader(context, buffer, string_buffers, shader, args, np2fixup);
+    if (cache->path && shader->reg_maps.shader_version.major < 4)
+    {
+        cache_key = shader_glsl_cache_get_shader_key(cache, context, shader, args, sizeof(*args));
+        if (shader_glsl_cache_load_source(cache, cache_key, buffer, np2fixup, sizeof(*np2fixup)))
+        {
+            ret = GL_EXTCALL(glCreateShader(GL_FRAGMENT_SHADER));
+            shader_glsl_compile(gl_info, ret, buffer->buffer);
+            gl_shaders[shader_data->num_gl_shaders++].id = ret;
+            return ret;
+        }
+        memset(np2fixup, 0, sizeof(*np2fixup));
+    }
+
+    ret = shader_glsl_generate_pshader(context, buffer, &priv->string_buffers, shader, args, np2fixup);
+    if (ret && cache_key)
+        shader_glsl_cache_store_source(cache, cache_key, buffer, np2fixup, sizeof(*np2fixup));
     gl_shaders[shader_data->num_gl_shaders++].id = ret;
 
     return ret;
@@ -8732,8 +9220,12 @@ static GLuint find_glsl_vshader(const struct wined3d_context *context, struct sh
     UINT i;
     DWORD new_size;
     DWORD use_map = context->stream_info.use_map;
+    const struct wined3d_gl_info *gl_info = context->gl_info;
+    struct glsl_shader_cache *cache = &priv->shader_cache;
     struct glsl_vs_compiled_shader *gl_shaders, *new_array;
     struct glsl_shader_private *shader_data;
+    struct vs_compile_args key_args;
+    UINT64 cache_key = 0;
     GLuint ret;
 
     if (!shader->backend_data)
@@ -8754,11 +9246,27 @@ static GLuint find_glsl_vshader(const struct wined3d_context *context, struct sh
     for (i = 0; i < shader_data->num_gl_shaders; ++i)
     {
         if (vs_args_equal(&gl_shaders[i].args, args, use_map))
+        {
+            shader_data->precompiled_id = 0;
             return gl_shaders[i].id;
+        }
     }
 
     TRACE("No matching GL shader found for shader %p, compiling a new shader.\n", shader);
 
+    /* See find_glsl_pshader(). */
+    for (i = 0; shader_data->precompiled_id && i < shader_data->num_gl_shaders; ++i)
+    {
+        if (gl_shaders[i].id != shader_data->precompiled_id)
+            continue;
+        TRACE("Deleting unused precompiled GL shader %u.\n", gl_shaders[i].id);
+        GL_EXTCALL(glDeleteShader(gl_shaders[i].id));
+        checkGLcall("glDeleteShader");
+        --shader_data->num_gl_shaders;
+        memmove(&gl_shaders[i], &gl_shaders[i + 1], (shader_data->num_gl_shaders - i) * sizeof(*gl_shaders));
+        shader_data->precompiled_id = 0;
+    }
+
     if (shader_data->shader_array_size == shader_data->num_gl_shaders)
     {
         if (shader_data->num_gl_shaders)
@@ -8784,7 +9292,33 @@ static GLuint find_glsl_vshader(const struct wined3d_context *context, struct sh
     gl_shaders[shader_data->num_gl_shaders].args = *args;
 
     string_buffer_clear(&priv->shader_buffer);
+    if (cache->path && shader->reg_maps.shader_version.major < 4)
+    {
+        /* Copy the fields individually, the padding bits aren't initialised. */
+        memset(&key_args, 0, sizeof(key_args));
+        key_args.fog_src = args->fog_src;
+        key_args.clip_enabled = args->clip_enabled;
+        key_args.point_size = args->point_size;
+        key_args.per_vertex_point_size = args->per_vertex_point_size;
+        key_args.flatshading = args->flatshading;
+        key_args.next_shader_type = args->next_shader_type;
+        key_args.swizzle_map = args->swizzle_map;
+        key_args.next_shader_input_count = args->next_shader_input_count;
+        memcpy(key_args.interpolation_mode, args->interpolation_mode, sizeof(key_args.interpolation_mode));
+
+        cache_key = shader_glsl_cache_get_shader_key(cache, context, shader, &key_args, sizeof(key_args));
+        if (shader_glsl_cache_load_source(cache, cache_key, &priv->shader_buffer, NULL, 0))
+        {
+            ret = GL_EXTCALL(glCreateShader(GL_VERTEX_SHADER));
+            shader_glsl_compile(gl_info, ret, priv->shader_buffer.buffer);
+            gl_shaders[shader_data->num_gl_shaders++].id = ret;
+            return ret;
+        }
+    }
+
     ret = shader_glsl_generate_vshader(context, priv, shader, args);
+    if (ret && cache_key)
+        shader_glsl_cache_store_source(cache, cache_key, &priv->shader_buffer, NULL, 0);
     gl_shaders[shader_data->num_gl_shaders++].id = ret;
 
     return ret;
@@ -10361,6 +10895,7 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
     struct wined3d_shader *pshader = NULL;
     GLuint reorder_shader_id = 0;
     struct glsl_program_key key;
+    UINT64 cache_key = 0;
     GLuint program_id;
     unsigned int i;
     GLuint vs_id = 0;
@@ -10452,8 +10987,7 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
         struct ps_compile_args ps_compile_args;
         pshader = state->shader[WINED3D_SHADER_TYPE_PIXEL];
         find_ps_compile_args(state, pshader, context->stream_info.position_transformed, &ps_compile_args, context);
-        ps_id = find_glsl_pshader(context, &priv->shader_buffer, &priv->string_buffers,
-                pshader, &ps_compile_args, &np2fixup_info);
+        ps_id = find_glsl_pshader(context, priv, pshader, &ps_compile_args, &np2fixup_info);
         ps_list = &pshader->linked_programs;
     }
     else if (priv->fragment_pipe == &glsl_fragment_pipe
@@ -10614,10 +11148,22 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
         list_add_head(ps_list, &entry->ps.shader_entry);
     }
 
-    /* Link the program */
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    /* Transform feedback varyings aren't part of the shader sources, so
+     * programs with a geometry shader aren't cached. */
+    if (priv->shader_cache.path && gl_info->supported[ARB_GET_PROGRAM_BINARY] && !gshader)
+        cache_key = shader_glsl_cache_get_program_key(&priv->shader_cache, context, program_id);
+
+    if (!cache_key || !shader_glsl_cache_load_program(&priv->shader_cache, gl_info, program_id, cache_key))
+    {
+        /* Link the program */
+        TRACE("Linking GLSL shader program %u.\n", program_id);
+        if (cache_key)
+            GL_EXTCALL(glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+        GL_EXTCALL(glLinkProgram(program_id));
+        shader_glsl_validate_link(gl_info, program_id);
+        if (cache_key)
+            shader_glsl_cache_store_program(&priv->shader_cache, gl_info, program_id, cache_key);
+    }
 
     shader_glsl_init_vs_uniform_locations(gl_info, priv, program_id, &entry->vs,
             vshader ? vshader->limits->constant_float : 0);
@@ -10773,14 +11319,60 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
 
 static void shader_glsl_precompile(void *shader_priv, struct wined3d_shader *shader)
 {
+    const struct ps_np2fixup_info *np2fixup_info = NULL;
     struct wined3d_device *device = shader->device;
+    const struct wined3d_state *state = &device->cs->state;
+    struct shader_glsl_priv *priv = shader_priv;
+    struct glsl_shader_private *shader_data;
     struct wined3d_context *context;
+    struct vs_compile_args vs_args;
+    struct ps_compile_args ps_args;
+    GLuint id;
 
-    if (shader->reg_maps.shader_version.type == WINED3D_SHADER_TYPE_COMPUTE)
+    /* With ARB_parallel_shader_compile, vertex and pixel shaders are
+     * translated and compiled for the current state when they're created,
+     * and the driver compiles them in the background until the program is
+     * linked. The state at creation time is usually a good prediction for
+     * the state at draw time; if it isn't, the first draw deletes the
+     * predicted variant and compiles another one as before. Without the
+     * extension compiling here would just move the stall, and a wrong
+     * prediction would make it worse. */
+    switch (shader->reg_maps.shader_version.type)
     {
-        context = context_acquire(device, NULL, 0);
-        shader_glsl_compile_compute_shader(shader_priv, context, shader);
-        context_release(context);
+        case WINED3D_SHADER_TYPE_VERTEX:
+            if (!device->adapter->gl_info.supported[ARB_PARALLEL_SHADER_COMPILE])
+                break;
+            context = context_acquire(device, NULL, 0);
+            find_vs_compile_args(state, shader, context->stream_info.swizzle_map, &vs_args, context);
+            if ((id = find_glsl_vshader(context, priv, shader, &vs_args)))
+            {
+                shader_data = shader->backend_data;
+                shader_data->precompiled_id = id;
+            }
+            context_release(context);
+            break;
+
+        case WINED3D_SHADER_TYPE_PIXEL:
+            if (!device->adapter->gl_info.supported[ARB_PARALLEL_SHADER_COMPILE])
+                break;
+            context = context_acquire(device, NULL, 0);
+            find_ps_compile_args(state, shader, context->stream_info.position_transformed, &ps_args, context);
+            if ((id = find_glsl_pshader(context, priv, shader, &ps_args, &np2fixup_info)))
+            {
+                shader_data = shader->backend_data;
+                shader_data->precompiled_id = id;
+            }
+            context_release(context);
+            break;
+
+        case WINED3D_SHADER_TYPE_COMPUTE:
+            context = context_acquire(device, NULL, 0);
+            shader_glsl_compile_compute_shader(shader_priv, context, shader);
+            context_release(context);
+            break;
+
+        default:
+            break;
     }
 }
 
@@ -11212,6 +11804,7 @@ static HRESULT shader_glsl_alloc(struct wined3d_device *device, const struct win
     fragment_pipe->get_caps(gl_info, &fragment_caps);
     priv->ffp_proj_control = fragment_caps.wined3d_caps & WINED3D_FRAGMENT_CAP_PROJ_CONTROL;
     priv->legacy_lighting = device->wined3d->flags & WINED3D_LEGACY_FFP_LIGHTING;
+    shader_glsl_cache_init(&priv->shader_cache);
 
     device->vertex_priv = vertex_priv;
     device->fragment_priv = fragment_priv;
@@ -11235,6 +11828,7 @@ static void shader_glsl_free(struct wined3d_device *device)
 {
     struct shader_glsl_priv *priv = device->shader_priv;
 
+    shader_glsl_cache_cleanup(&priv->shader_cache);
     wine_rb_destroy(&priv->program_lookup, NULL, NULL);
     constant_heap_free(&priv->pconst_heap);
     constant_heap_free(&priv->vconst_heap);
@@ -398,6 +398,9 @@ struct wined3d_settings
     unsigned int max_sm_ps;
     unsigned int max_sm_cs;
     BOOL no_3d;
+    BOOL shader_cache;
+    char *shader_cache_path;
+    unsigned int shader_cache_size;
 };
 
 extern struct wined3d_settings wined3d_settings DECLSPEC_HIDDEN;
@@ -1707,6 +1710,8 @@ struct wined3d_fence
 HRESULT wined3d_fence_create(struct wined3d_device *device, struct wined3d_fence **fence) DECLSPEC_HIDDEN;
 void wined3d_fence_destroy(struct wined3d_fence *fence) DECLSPEC_HIDDEN;
 void wined3d_fence_issue(struct wined3d_fence *fence, const struct wined3d_device *device) DECLSPEC_HIDDEN;
+enum wined3d_fence_result wined3d_fence_test(const struct wined3d_fence *fence,
+        const struct wined3d_device *device, DWORD flags) DECLSPEC_HIDDEN;
 enum wined3d_fence_result wined3d_fence_wait(const struct wined3d_fence *fence,
         const struct wined3d_device *device) DECLSPEC_HIDDEN;
 
@@ -3608,6 +3613,7 @@ enum wined3d_push_constants
 #define WINED3D_CS_QUERY_POLL_INTERVAL  10u
 #define WINED3D_CS_QUEUE_SIZE           0x100000u
 #define WINED3D_CS_SPIN_COUNT           10000000u
+#define WINED3D_CS_SPIN_COUNT_MIN       10000u
 
 struct wined3d_cs_queue
 {
@@ -3624,6 +3630,17 @@ struct wined3d_cs_ops
             unsigned int start_idx, unsigned int count, const void *constants);
 };
 
+struct wined3d_cs_state_batch
+{
+    unsigned int count;
+    DWORD render_state_mask[(WINEHIGHEST_RENDER_STATE >> 5) + 1];
+    DWORD texture_state_mask[MAX_TEXTURES];     /* WINED3D_HIGHEST_TEXTURE_STATE + 1, 18 */
+    WORD sampler_state_mask[MAX_COMBINED_SAMPLERS]; /* WINED3D_HIGHEST_SAMPLER_STATE + 1, 14 */
+    DWORD render_states[WINEHIGHEST_RENDER_STATE + 1];
+    DWORD texture_states[MAX_TEXTURES][WINED3D_HIGHEST_TEXTURE_STATE + 1];
+    DWORD sampler_states[MAX_COMBINED_SAMPLERS][WINED3D_HIGHEST_SAMPLER_STATE + 1];
+};
+
 struct wined3d_cs
 {
     const struct wined3d_cs_ops *ops;
@@ -3643,6 +3660,8 @@ struct wined3d_cs
     HANDLE event;
     BOOL waiting_for_event;
     LONG pending_presents;
+
+    struct wined3d_cs_state_batch state_batch;
 };
 
 struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device) DECLSPEC_HIDDEN;
@@ -3732,6 +3751,7 @@ void wined3d_cs_emit_unload_resource(struct wined3d_cs *cs, struct wined3d_resou
 void wined3d_cs_emit_update_sub_resource(struct wined3d_cs *cs, struct wined3d_resource *resource,
         unsigned int sub_resource_idx, const struct wined3d_box *box, const void *data, unsigned int row_pitch,
         unsigned int slice_pitch) DECLSPEC_HIDDEN;
+void wined3d_cs_flush_states(struct wined3d_cs *cs) DECLSPEC_HIDDEN;
 void wined3d_cs_init_object(struct wined3d_cs *cs,
         void (*callback)(void *object), void *object) DECLSPEC_HIDDEN;
 HRESULT wined3d_cs_map(struct wined3d_cs *cs, struct wined3d_resource *resource, unsigned int sub_resource_idx,
@@ -3741,6 +3761,8 @@ HRESULT wined3d_cs_unmap(struct wined3d_cs *cs, struct wined3d_resource *resourc
 
 static inline void wined3d_cs_finish(struct wined3d_cs *cs, enum wined3d_cs_queue_id queue_id)
 {
+    if (queue_id == WINED3D_CS_QUEUE_DEFAULT && cs->state_batch.count)
+        wined3d_cs_flush_states(cs);
     cs->ops->finish(cs, queue_id);
 }
 
@@ -3815,6 +3837,18 @@ void wined3d_buffer_copy(struct wined3d_buffer *dst_buffer, unsigned int dst_off
 void wined3d_buffer_upload_data(struct wined3d_buffer *buffer, struct wined3d_context *context,
         const struct wined3d_box *box, const void *data) DECLSPEC_HIDDEN;
 
+#define WINED3D_BUFFER_GL_MAX_STREAM_BOS 4
+
+/* A persistently mapped buffer object backing a dynamic buffer. The fence is
+ * issued when the buffer object is retired by a DISCARD map, and tested
+ * before the buffer object is reused. */
+struct wined3d_buffer_gl_stream_bo
+{
+    GLuint name;
+    BYTE *ptr;
+    struct wined3d_fence *fence;
+};
+
 struct wined3d_buffer_gl
 {
     struct wined3d_buffer b;
@@ -3822,6 +3856,9 @@ struct wined3d_buffer_gl
     GLuint buffer_object;
     GLenum buffer_object_usage;
     GLenum buffer_type_hint;
+
+    struct wined3d_buffer_gl_stream_bo stream_bos[WINED3D_BUFFER_GL_MAX_STREAM_BOS];
+    unsigned int stream_bo_count, stream_bo_idx;
 };
 
 static inline struct wined3d_buffer_gl *wined3d_buffer_gl(struct wined3d_buffer *buffer)
@@ -64,6 +64,9 @@
 #ifdef HAVE_SYS_UIO_H
 # include <sys/uio.h>
 #endif
+#ifdef HAVE_SYS_SENDFILE_H
+# include <sys/sendfile.h>
+#endif
 #ifdef HAVE_SYS_SOCKET_H
 #include <sys/socket.h>
 #endif
@@ -157,6 +160,7 @@
 #include "wine/server.h"
 #include "wine/debug.h"
 #include "wine/exception.h"
+#include "wine/list.h"
 #include "wine/unicode.h"
 
 #if defined(linux) && !defined(IP_UNICAST_IF)
@@ -265,6 +269,8 @@ static int WS2_recv_base( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
                           LPWSAOVERLAPPED_COMPLETION_ROUTINE lpCompletionRoutine,
                           LPWSABUF lpControlBuffer );
 
+static void rio_close_socket( SOCKET s );
+
 /* critical section to protect some non-reentrant net function */
 static CRITICAL_SECTION csWSgetXXXbyYYY;
 static CRITICAL_SECTION_DEBUG critsect_debug =
@@ -534,6 +540,7 @@ struct ws2_transmitfile_async
     TRANSMIT_FILE_BUFFERS buffers;
     DWORD                 flags;
     LARGE_INTEGER         offset;
+    BOOL                  use_sendfile;
     struct ws2_async      write;
 };
 
@@ -2469,8 +2476,8 @@ static NTSTATUS WS2_async_recv( void *user, IO_STATUS_BLOCK *iosb, NTSTATUS stat
     }
     if (status != STATUS_PENDING)
     {
-        iosb->u.Status = status;
         iosb->Information = result;
+        iosb->u.Status = status;
         if (!wsa->completion_func)
             release_async_io( &wsa->io );
     }
@@ -2985,6 +2992,14 @@ static NTSTATUS WS2_transmitfile_getbuffer( int fd, struct ws2_transmitfile_asyn
         IO_STATUS_BLOCK iosb;
         NTSTATUS status;
 
+        if (wsa->use_sendfile)
+        {
+            /* the data is sent straight from the file by WS2_transmitfile_base */
+            wsa->write.first_iovec = 0;
+            wsa->write.n_iovecs    = 0;
+            return STATUS_PENDING;
+        }
+
         iosb.Information = 0;
         /* when the size of the transfer is limited ensure that we don't go past that limit */
         if (wsa->file_bytes != 0)
@@ -3028,6 +3043,70 @@ static NTSTATUS WS2_transmitfile_getbuffer( int fd, struct ws2_transmitfile_asyn
     return STATUS_SUCCESS;
 }
 
+/***********************************************************************
+ *     WS2_transmitfile_sendfile        (INTERNAL)
+ *
+ * Send the next part of the file without copying it through a user buffer.
+ */
+static int WS2_transmitfile_sendfile( int fd, struct ws2_transmitfile_async *wsa )
+{
+#ifdef HAVE_SYS_SENDFILE_H
+    size_t count = INT_MAX;
+    off_t offset, *offset_ptr = NULL;
+    int file_fd, n;
+
+    if (wine_server_handle_to_fd( wsa->file, FILE_READ_DATA, &file_fd, NULL ))
+    {
+        errno = EBADF;
+        return -1;
+    }
+
+    /* when the size of the transfer is limited ensure that we don't go past that limit */
+    if (wsa->file_bytes != 0)
+        count = wsa->file_bytes - wsa->file_read;
+    if (wsa->offset.QuadPart != FILE_USE_FILE_POINTER_POSITION)
+    {
+        offset = wsa->offset.QuadPart;
+        offset_ptr = &offset;
+    }
+
+    do n = sendfile( fd, file_fd, offset_ptr, count );
+    while (n == -1 && errno == EINTR);
+    wine_server_release_fd( wsa->file, file_fd );
+
+    if (n == -1)
+    {
+        if (errno != EINVAL && errno != ENOSYS) return -1;
+        /* not supported for this file, fall back to reading it */
+        TRACE( "sendfile failed, falling back to read and send\n" );
+        wsa->use_sendfile = FALSE;
+        return 0;
+    }
+
+    if (offset_ptr) wsa->offset.QuadPart += n;
+    wsa->file_read += n;
+    if (!n || (wsa->file_bytes != 0 && wsa->file_read >= wsa->file_bytes))
+        wsa->file = NULL; /* continue on to the footer */
+    return n;
+#else
+    wsa->use_sendfile = FALSE;
+    return 0;
+#endif
+}
+
+/***********************************************************************
+ *     WS2_transmitfile_cork            (INTERNAL)
+ *
+ * Hold back partial frames while the pieces of a transfer are sent, so that
+ * the header, file data and footer are coalesced as if sent in one call.
+ */
+static void WS2_transmitfile_cork( int fd, int cork )
+{
+#ifdef TCP_CORK
+    setsockopt( fd, IPPROTO_TCP, TCP_CORK, &cork, sizeof(cork) );
+#endif
+}
+
 /***********************************************************************
  *     WS2_transmitfile_base            (INTERNAL)
  *
@@ -3043,7 +3122,10 @@ static NTSTATUS WS2_transmitfile_base( int fd, struct ws2_transmitfile_async *ws
         IO_STATUS_BLOCK *iosb = (IO_STATUS_BLOCK *)wsa->write.user_overlapped;
         int n;
 
-        n = WS2_send( fd, &wsa->write, convert_flags(wsa->write.flags) );
+        if (!wsa->write.n_iovecs)
+            n = WS2_transmitfile_sendfile( fd, wsa );
+        else
+            n = WS2_send( fd, &wsa->write, convert_flags(wsa->write.flags) );
         if (n >= 0)
         {
             if (iosb) iosb->Information += n;
@@ -3065,15 +3147,24 @@ static NTSTATUS WS2_async_transmitfile( void *user, IO_STATUS_BLOCK *iosb, NTSTA
     struct ws2_transmitfile_async *wsa = user;
     int fd;
 
-    if (status == STATUS_ALERTED)
+    if (status == STATUS_ALERTED &&
+        !(status = wine_server_handle_to_fd( wsa->write.hSocket, FILE_WRITE_DATA, &fd, NULL )))
     {
-        if (!(status = wine_server_handle_to_fd( wsa->write.hSocket, FILE_WRITE_DATA, &fd, NULL )))
+        status = WS2_transmitfile_base( fd, wsa );
+        if (status == STATUS_PENDING)
         {
-            status = WS2_transmitfile_base( fd, wsa );
             wine_server_release_fd( wsa->write.hSocket, fd );
-        }
-        if (status == STATUS_PENDING)
             return status;
+        }
+    }
+    else if (wine_server_handle_to_fd( wsa->write.hSocket, 0, &fd, NULL ))
+        fd = -1;
+
+    /* the socket was corked by WS2_TransmitFile, uncork it however the transfer ended */
+    if (fd != -1)
+    {
+        WS2_transmitfile_cork( fd, 0 );
+        wine_server_release_fd( wsa->write.hSocket, fd );
     }
 
     iosb->u.Status = status;
@@ -3142,6 +3233,7 @@ static BOOL WINAPI WS2_TransmitFile( SOCKET s, HANDLE h, DWORD file_bytes, DWORD
     wsa->bytes_per_send        = bytes_per_send;
     wsa->flags                 = flags;
     wsa->offset.QuadPart       = FILE_USE_FILE_POINTER_POSITION;
+    wsa->use_sendfile          = (h != NULL);
     wsa->write.hSocket         = SOCKET2HANDLE(s);
     wsa->write.addr            = NULL;
     wsa->write.addrlen.val     = 0;
@@ -3151,6 +3243,7 @@ static BOOL WINAPI WS2_TransmitFile( SOCKET s, HANDLE h, DWORD file_bytes, DWORD
     wsa->write.n_iovecs        = 0;
     wsa->write.first_iovec     = 0;
     wsa->write.user_overlapped = overlapped;
+    WS2_transmitfile_cork( fd, 1 );
     if (overlapped)
     {
         IO_STATUS_BLOCK *iosb = (IO_STATUS_BLOCK *)overlapped;
@@ -3162,7 +3255,11 @@ static BOOL WINAPI WS2_TransmitFile( SOCKET s, HANDLE h, DWORD file_bytes, DWORD
         iosb->Information = 0;
         status = register_async( ASYNC_TYPE_WRITE, SOCKET2HANDLE(s), &wsa->io,
                                  overlapped->hEvent, NULL, NULL, iosb );
-        if(status != STATUS_PENDING) HeapFree( GetProcessHeap(), 0, wsa );
+        if(status != STATUS_PENDING)
+        {
+            WS2_transmitfile_cork( fd, 0 );
+            HeapFree( GetProcessHeap(), 0, wsa );
+        }
         release_sock_fd( s, fd );
         WSASetLastError( NtStatusToWSAError(status) );
         return FALSE;
@@ -3179,6 +3276,7 @@ static BOOL WINAPI WS2_TransmitFile( SOCKET s, HANDLE h, DWORD file_bytes, DWORD
         }
     }
     while (status == STATUS_PENDING);
+    WS2_transmitfile_cork( fd, 0 );
     release_sock_fd( s, fd );
 
     if (status != STATUS_SUCCESS)
@@ -3418,6 +3516,7 @@ int WINAPI WS_closesocket(SOCKET s)
         if (fd >= 0)
         {
             release_sock_fd(s, fd);
+            rio_close_socket(s);
             if (CloseHandle(SOCKET2HANDLE(s)))
                 res = 0;
         }
@@ -3646,6 +3745,577 @@ static BOOL WINAPI WS2_DisconnectEx( SOCKET s, LPOVERLAPPED ov, DWORD flags, DWO
     return !WS_shutdown( s, SD_BOTH );
 }
 
+/***********************************************************************
+ *     Registered I/O extensions
+ *
+ * Requests are attempted right away, and only queued on the server as
+ * asyncs when the socket isn't ready.  Completed requests are pushed on
+ * a lock-free list of their completion queue, from the async callback if
+ * needed, and RIODequeueCompletion reaps them in completion order.
+ */
+
+struct rio_buffer
+{
+    char  *data;
+    DWORD  size;
+};
+
+struct rio_cq
+{
+    SLIST_HEADER                completed; /* requests completed since the last dequeue */
+    CRITICAL_SECTION            cs;
+    RIO_NOTIFICATION_COMPLETION notify;    /* Type is 0 for polled queues */
+    LONG                        notify_armed; /* set by RIONotify until the next completion */
+    HANDLE                      event;     /* signaled when a request queued on the server completes */
+    LONG                        queued;    /* number of requests queued on the server */
+    DWORD                       size;      /* maximum number of outstanding requests */
+    DWORD                       count;     /* current number of outstanding requests */
+    struct list                 requests;  /* outstanding requests not yet seen completed */
+    struct list                 done;      /* completed requests in completion order */
+};
+
+struct rio_rq
+{
+    struct list    entry;        /* entry in the list of request queues */
+    LONG           refcount;     /* one for the socket, and one per outstanding request */
+    SOCKET         socket;
+    ULONGLONG      context;
+    struct rio_cq *recv_cq;
+    struct rio_cq *send_cq;
+    ULONG          max_recv;
+    ULONG          max_send;
+    ULONG          recv_count;   /* protected by recv_cq->cs */
+    ULONG          send_count;   /* protected by send_cq->cs */
+};
+
+struct rio_request
+{
+    SLIST_ENTRY      completed;  /* entry in the completed list of the queue */
+    struct list      entry;      /* entry in the requests or done list of the queue */
+    IO_STATUS_BLOCK  iosb;       /* final status, set before the request is published */
+    IO_STATUS_BLOCK *async_iosb; /* status block of the async while queued on the server */
+    struct rio_rq   *rq;
+    struct rio_cq   *cq;
+    BOOL             is_send;
+    BOOL             notify;     /* whether the completion triggers RIONotify */
+    INT              addrlen;
+    PVOID            context;
+};
+
+/* request queues, released when their socket is closed */
+static struct list rio_rqs = LIST_INIT( rio_rqs );
+static CRITICAL_SECTION rio_cs;
+static CRITICAL_SECTION_DEBUG rio_cs_debug =
+{
+    0, 0, &rio_cs,
+    { &rio_cs_debug.ProcessLocksList, &rio_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": rio_cs") }
+};
+static CRITICAL_SECTION rio_cs = { &rio_cs_debug, -1, 0, 0, 0, 0 };
+
+static void release_rio_rq( struct rio_rq *rq )
+{
+    if (!InterlockedDecrement( &rq->refcount )) HeapFree( GetProcessHeap(), 0, rq );
+}
+
+/* release the request queues of a socket that is being closed */
+static void rio_close_socket( SOCKET s )
+{
+    struct rio_rq *rq, *next;
+
+    EnterCriticalSection( &rio_cs );
+    LIST_FOR_EACH_ENTRY_SAFE( rq, next, &rio_rqs, struct rio_rq, entry )
+    {
+        if (rq->socket != s) continue;
+        list_remove( &rq->entry );
+        release_rio_rq( rq );
+    }
+    LeaveCriticalSection( &rio_cs );
+}
+
+static void rio_signal( struct rio_cq *cq )
+{
+    if (cq->notify.Type == RIO_EVENT_COMPLETION)
+        SetEvent( cq->notify.u.Event.EventHandle );
+    else
+        PostQueuedCompletionStatus( cq->notify.u.Iocp.IocpHandle, 0, (ULONG_PTR)cq->notify.u.Iocp.CompletionKey,
+                                    cq->notify.u.Iocp.Overlapped );
+}
+
+/* publish a completed request; the request may be dequeued and freed as soon as this is called */
+static void rio_complete_request( struct rio_request *req )
+{
+    struct rio_cq *cq = req->cq;
+    BOOL notify = req->notify;
+
+    InterlockedPushEntrySList( &cq->completed, &req->completed );
+    if (notify && InterlockedExchange( &cq->notify_armed, 0 )) rio_signal( cq );
+}
+
+/* move the requests completed since the last call to the done list, in completion order */
+static void rio_collect_completions( struct rio_cq *cq )
+{
+    struct list *last = cq->done.prev;
+    SLIST_ENTRY *entry = InterlockedFlushSList( &cq->completed );
+
+    /* the flushed list has the most recent completion first */
+    while (entry)
+    {
+        struct rio_request *req = CONTAINING_RECORD( entry, struct rio_request, completed );
+
+        entry = entry->Next;
+        list_remove( &req->entry );
+        list_add_after( last, &req->entry );
+    }
+}
+
+static BOOL rio_cq_has_completions( struct rio_cq *cq )
+{
+    return !list_empty( &cq->done ) || QueryDepthSList( &cq->completed );
+}
+
+/* free a dequeued request; must be called with the queue lock held */
+static void rio_free_request( struct rio_cq *cq, struct rio_request *req )
+{
+    if (req->is_send) req->rq->send_count--;
+    else req->rq->recv_count--;
+    cq->count--;
+    list_remove( &req->entry );
+    release_rio_rq( req->rq );
+    HeapFree( GetProcessHeap(), 0, req );
+}
+
+struct rio_async
+{
+    struct ws2_async    wsa;     /* must be first, ends with the iovec array */
+    struct rio_request *req;
+};
+
+/* async callback of the requests that had to be queued on the server; the
+ * status block belongs to the async, since ntdll still uses it after the
+ * callback returns, and the request can be freed as soon as it is published */
+static NTSTATUS rio_async_io( void *user, IO_STATUS_BLOCK *iosb, NTSTATUS status )
+{
+    struct rio_request *req = ((struct rio_async *)user)->req;
+    struct rio_cq *cq = req->cq;
+
+    if (req->is_send) status = WS2_async_send( user, iosb, status );
+    else status = WS2_async_recv( user, iosb, status );
+
+    if (status != STATUS_PENDING)
+    {
+        req->iosb.u.Status    = iosb->u.Status;
+        req->iosb.Information = iosb->Information;
+        rio_complete_request( req );
+        InterlockedDecrement( &cq->queued );
+    }
+    return status;
+}
+
+static struct rio_buffer *get_rio_buffer( const RIO_BUF *buf )
+{
+    struct rio_buffer *buffer = (struct rio_buffer *)buf->BufferId;
+
+    if (!buffer || buf->BufferId == RIO_INVALID_BUFFERID ||
+        buf->Offset > buffer->size || buf->Length > buffer->size - buf->Offset)
+        return NULL;
+    return buffer;
+}
+
+static BOOL rio_post_request( struct rio_rq *rq, BOOL is_send, const RIO_BUF *data, ULONG count,
+                              const RIO_BUF *remote, DWORD flags, PVOID context )
+{
+    struct rio_cq *cq = is_send ? rq->send_cq : rq->recv_cq;
+    struct rio_buffer *buffer, *addr_buffer = NULL;
+    struct rio_request *req;
+    struct rio_async *async;
+    struct ws2_async *wsa;
+    ULONG *req_count, max_count;
+    NTSTATUS status;
+    int n, fd;
+
+    if (flags & ~(RIO_MSG_DONT_NOTIFY | RIO_MSG_DEFER | RIO_MSG_WAITALL | RIO_MSG_COMMIT_ONLY))
+    {
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+    /* deferred requests are always submitted right away */
+    if (flags & RIO_MSG_COMMIT_ONLY) return TRUE;
+
+    if (count != 1 || !data || !(buffer = get_rio_buffer( data )) ||
+        (remote && !(addr_buffer = get_rio_buffer( remote ))))
+    {
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+    if (flags & RIO_MSG_WAITALL) FIXME( "RIO_MSG_WAITALL not supported\n" );
+
+    if (!(req = HeapAlloc( GetProcessHeap(), 0, sizeof(*req) )))
+    {
+        SetLastError( WSAENOBUFS );
+        return FALSE;
+    }
+    if (!(async = (struct rio_async *)alloc_async_io( sizeof(*async), rio_async_io )))
+    {
+        HeapFree( GetProcessHeap(), 0, req );
+        SetLastError( WSAENOBUFS );
+        return FALSE;
+    }
+    async->req = req;
+    wsa = &async->wsa;
+    wsa->local_iosb.u.Status    = STATUS_PENDING;
+    wsa->local_iosb.Information = 0;
+    req->iosb       = wsa->local_iosb;
+    req->async_iosb = &wsa->local_iosb;
+    req->rq      = rq;
+    req->cq      = cq;
+    req->is_send = is_send;
+    req->notify  = !(flags & RIO_MSG_DONT_NOTIFY);
+    req->addrlen = remote ? remote->Length : 0;
+    req->context = context;
+
+    wsa->hSocket         = SOCKET2HANDLE(rq->socket);
+    wsa->user_overlapped = NULL;
+    wsa->completion_func = NULL;
+    wsa->addr            = remote ? (struct WS_sockaddr *)(addr_buffer->data + remote->Offset) : NULL;
+    if (is_send) wsa->addrlen.val = req->addrlen;
+    else wsa->addrlen.ptr = remote ? &req->addrlen : NULL;
+    wsa->flags           = 0;
+    wsa->lpFlags         = &wsa->flags;
+    wsa->control         = NULL;
+    wsa->n_iovecs        = 1;
+    wsa->first_iovec     = 0;
+    wsa->iovec[0].iov_base = buffer->data + data->Offset;
+    wsa->iovec[0].iov_len  = data->Length;
+
+    if ((fd = get_sock_fd( rq->socket, is_send ? FILE_WRITE_DATA : FILE_READ_DATA, NULL )) == -1)
+    {
+        HeapFree( GetProcessHeap(), 0, wsa );
+        HeapFree( GetProcessHeap(), 0, req );
+        return FALSE;
+    }
+
+    EnterCriticalSection( &cq->cs );
+
+    req_count = is_send ? &rq->send_count : &rq->recv_count;
+    max_count = is_send ? rq->max_send : rq->max_recv;
+    if (*req_count >= max_count || cq->count >= cq->size)
+    {
+        LeaveCriticalSection( &cq->cs );
+        release_sock_fd( rq->socket, fd );
+        HeapFree( GetProcessHeap(), 0, wsa );
+        HeapFree( GetProcessHeap(), 0, req );
+        SetLastError( WSAENOBUFS );
+        return FALSE;
+    }
+    list_add_tail( &cq->requests, &req->entry );
+    (*req_count)++;
+    cq->count++;
+    InterlockedIncrement( &rq->refcount );
+    LeaveCriticalSection( &cq->cs );
+
+    /* try the I/O right away, and only go through the server if the socket isn't ready */
+    if (is_send) n = WS2_send( fd, wsa, 0 );
+    else n = WS2_recv( fd, wsa, 0 );
+
+    if (n >= 0)
+    {
+        wsa->local_iosb.Information = n;
+        /* sends complete once all the data is written, the rest is queued */
+        status = (is_send && wsa->first_iovec < wsa->n_iovecs) ? STATUS_PENDING : STATUS_SUCCESS;
+    }
+    else if (errno == EAGAIN) status = STATUS_PENDING;
+    else status = wsaErrStatus();
+    release_sock_fd( rq->socket, fd );
+
+    if (status == STATUS_PENDING)
+    {
+        InterlockedIncrement( &cq->queued );
+        status = register_async( is_send ? ASYNC_TYPE_WRITE : ASYNC_TYPE_READ, SOCKET2HANDLE(rq->socket),
+                                 &wsa->io, cq->event, NULL, NULL, &wsa->local_iosb );
+        if (is_send) _enable_event( SOCKET2HANDLE(rq->socket), FD_WRITE, 0, 0 );
+        if (status == STATUS_PENDING) return TRUE;
+        InterlockedDecrement( &cq->queued );
+    }
+    else if (!is_send && status == STATUS_SUCCESS) _enable_event( SOCKET2HANDLE(rq->socket), FD_READ, 0, 0 );
+
+    req->iosb.u.Status    = status;
+    req->iosb.Information = wsa->local_iosb.Information;
+    HeapFree( GetProcessHeap(), 0, wsa );
+    rio_complete_request( req );
+    return TRUE;
+}
+
+static BOOL WINAPI WS2_RIOReceive( RIO_RQ rq, PRIO_BUF data, ULONG count, DWORD flags, PVOID context )
+{
+    TRACE( "rq %p, data %p, count %u, flags %#x, context %p\n", rq, data, count, flags, context );
+
+    return rio_post_request( (struct rio_rq *)rq, FALSE, data, count, NULL, flags, context );
+}
+
+static int WINAPI WS2_RIOReceiveEx( RIO_RQ rq, PRIO_BUF data, ULONG count, PRIO_BUF local_addr,
+                                    PRIO_BUF remote_addr, PRIO_BUF control, PRIO_BUF out_flags,
+                                    DWORD flags, PVOID context )
+{
+    TRACE( "rq %p, data %p, count %u, local %p, remote %p, control %p, out_flags %p, flags %#x, context %p\n",
+           rq, data, count, local_addr, remote_addr, control, out_flags, flags, context );
+
+    if (local_addr || control || out_flags)
+        FIXME( "local address, control and flags buffers not supported\n" );
+
+    return rio_post_request( (struct rio_rq *)rq, FALSE, data, count, remote_addr, flags, context );
+}
+
+static BOOL WINAPI WS2_RIOSend( RIO_RQ rq, PRIO_BUF data, ULONG count, DWORD flags, PVOID context )
+{
+    TRACE( "rq %p, data %p, count %u, flags %#x, context %p\n", rq, data, count, flags, context );
+
+    return rio_post_request( (struct rio_rq *)rq, TRUE, data, count, NULL, flags, context );
+}
+
+static BOOL WINAPI WS2_RIOSendEx( RIO_RQ rq, PRIO_BUF data, ULONG count, PRIO_BUF local_addr,
+                                  PRIO_BUF remote_addr, PRIO_BUF control, PRIO_BUF in_flags,
+                                  DWORD flags, PVOID context )
+{
+    TRACE( "rq %p, data %p, count %u, local %p, remote %p, control %p, in_flags %p, flags %#x, context %p\n",
+           rq, data, count, local_addr, remote_addr, control, in_flags, flags, context );
+
+    if (local_addr || control || in_flags)
+        FIXME( "local address, control and flags buffers not supported\n" );
+
+    return rio_post_request( (struct rio_rq *)rq, TRUE, data, count, remote_addr, flags, context );
+}
+
+static RIO_CQ WINAPI WS2_RIOCreateCompletionQueue( DWORD size, PRIO_NOTIFICATION_COMPLETION notify )
+{
+    struct rio_cq *cq;
+
+    TRACE( "size %u, notify %p\n", size, notify );
+
+    if (!size || size > RIO_MAX_CQ_SIZE ||
+        (notify && notify->Type != RIO_EVENT_COMPLETION && notify->Type != RIO_IOCP_COMPLETION))
+    {
+        SetLastError( WSAEINVAL );
+        return RIO_INVALID_CQ;
+    }
+
+    if (!(cq = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*cq) )))
+    {
+        SetLastError( WSAENOBUFS );
+        return RIO_INVALID_CQ;
+    }
+    if (!(cq->event = CreateEventW( NULL, FALSE, FALSE, NULL )))
+    {
+        HeapFree( GetProcessHeap(), 0, cq );
+        SetLastError( WSAENOBUFS );
+        return RIO_INVALID_CQ;
+    }
+    if (notify) cq->notify = *notify;
+    cq->size = size;
+    InitializeSListHead( &cq->completed );
+    list_init( &cq->requests );
+    list_init( &cq->done );
+    InitializeCriticalSection( &cq->cs );
+    cq->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": rio_cq.cs");
+    return (RIO_CQ)cq;
+}
+
+static void WINAPI WS2_RIOCloseCompletionQueue( RIO_CQ cq_id )
+{
+    struct rio_cq *cq = (struct rio_cq *)cq_id;
+    struct rio_request *req, *next;
+
+    TRACE( "cq %p\n", cq );
+
+    if (!cq) return;
+
+    /* the async callbacks of requests queued on the server still use the queue */
+    EnterCriticalSection( &cq->cs );
+    LIST_FOR_EACH_ENTRY( req, &cq->requests, struct rio_request, entry )
+    {
+        if (req->iosb.u.Status == STATUS_PENDING)
+            CancelIoEx( SOCKET2HANDLE(req->rq->socket), (OVERLAPPED *)req->async_iosb );
+    }
+    LeaveCriticalSection( &cq->cs );
+    while (cq->queued) WaitForSingleObject( cq->event, INFINITE );
+
+    EnterCriticalSection( &cq->cs );
+    rio_collect_completions( cq );
+    LIST_FOR_EACH_ENTRY_SAFE( req, next, &cq->done, struct rio_request, entry )
+        rio_free_request( cq, req );
+    LeaveCriticalSection( &cq->cs );
+
+    cq->cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection( &cq->cs );
+    CloseHandle( cq->event );
+    HeapFree( GetProcessHeap(), 0, cq );
+}
+
+static BOOL WINAPI WS2_RIOResizeCompletionQueue( RIO_CQ cq_id, DWORD size )
+{
+    struct rio_cq *cq = (struct rio_cq *)cq_id;
+    BOOL ret = TRUE;
+
+    TRACE( "cq %p, size %u\n", cq, size );
+
+    if (!cq || !size || size > RIO_MAX_CQ_SIZE)
+    {
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+
+    EnterCriticalSection( &cq->cs );
+    if (size < cq->count)
+    {
+        SetLastError( WSAETOOMANYREFS );
+        ret = FALSE;
+    }
+    else cq->size = size;
+    LeaveCriticalSection( &cq->cs );
+    return ret;
+}
+
+static RIO_RQ WINAPI WS2_RIOCreateRequestQueue( SOCKET s, ULONG max_recv, ULONG max_recv_buffers,
+                                                ULONG max_send, ULONG max_send_buffers,
+                                                RIO_CQ recv_cq, RIO_CQ send_cq, PVOID context )
+{
+    struct rio_rq *rq;
+    int fd;
+
+    TRACE( "socket %04lx, recv %u/%u, send %u/%u, cq %p/%p, context %p\n", s, max_recv,
+           max_recv_buffers, max_send, max_send_buffers, recv_cq, send_cq, context );
+
+    if (!recv_cq || !send_cq || max_recv_buffers > 1 || max_send_buffers > 1)
+    {
+        SetLastError( WSAEINVAL );
+        return RIO_INVALID_RQ;
+    }
+    if ((fd = get_sock_fd( s, 0, NULL )) == -1) return RIO_INVALID_RQ;
+    release_sock_fd( s, fd );
+
+    if (!(rq = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*rq) )))
+    {
+        SetLastError( WSAENOBUFS );
+        return RIO_INVALID_RQ;
+    }
+    /* completions keep a reference, they may be dequeued after the socket is closed */
+    rq->refcount = 1;
+    rq->socket   = s;
+    rq->context  = (ULONG_PTR)context;
+    rq->recv_cq  = (struct rio_cq *)recv_cq;
+    rq->send_cq  = (struct rio_cq *)send_cq;
+    rq->max_recv = max_recv;
+    rq->max_send = max_send;
+
+    EnterCriticalSection( &rio_cs );
+    list_add_tail( &rio_rqs, &rq->entry );
+    LeaveCriticalSection( &rio_cs );
+    return (RIO_RQ)rq;
+}
+
+static BOOL WINAPI WS2_RIOResizeRequestQueue( RIO_RQ rq_id, DWORD max_recv, DWORD max_send )
+{
+    struct rio_rq *rq = (struct rio_rq *)rq_id;
+
+    TRACE( "rq %p, recv %u, send %u\n", rq, max_recv, max_send );
+
+    if (!rq)
+    {
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+
+    EnterCriticalSection( &rq->recv_cq->cs );
+    rq->max_recv = max_recv;
+    LeaveCriticalSection( &rq->recv_cq->cs );
+    EnterCriticalSection( &rq->send_cq->cs );
+    rq->max_send = max_send;
+    LeaveCriticalSection( &rq->send_cq->cs );
+    return TRUE;
+}
+
+static ULONG WINAPI WS2_RIODequeueCompletion( RIO_CQ cq_id, PRIORESULT results, ULONG count )
+{
+    struct rio_cq *cq = (struct rio_cq *)cq_id;
+    struct rio_request *req;
+    struct list *ptr;
+    ULONG i = 0;
+
+    TRACE( "cq %p, results %p, count %u\n", cq, results, count );
+
+    if (!cq || !results) return RIO_CORRUPT_CQ;
+
+    EnterCriticalSection( &cq->cs );
+    rio_collect_completions( cq );
+    while (i < count && (ptr = list_head( &cq->done )))
+    {
+        req = LIST_ENTRY( ptr, struct rio_request, entry );
+        results[i].Status           = NtStatusToWSAError( req->iosb.u.Status );
+        results[i].BytesTransferred = req->iosb.Information;
+        results[i].SocketContext    = req->rq->context;
+        results[i].RequestContext   = (ULONG_PTR)req->context;
+        i++;
+        rio_free_request( cq, req );
+    }
+    LeaveCriticalSection( &cq->cs );
+
+    TRACE( "-> %u completions\n", i );
+    return i;
+}
+
+static int WINAPI WS2_RIONotify( RIO_CQ cq_id )
+{
+    struct rio_cq *cq = (struct rio_cq *)cq_id;
+    int ret = 0;
+
+    TRACE( "cq %p\n", cq );
+
+    if (!cq || !cq->notify.Type) return WSAEINVAL;
+
+    EnterCriticalSection( &cq->cs );
+    if (cq->notify_armed) ret = WSAEALREADY;
+    else
+    {
+        if (cq->notify.Type == RIO_EVENT_COMPLETION && cq->notify.u.Event.NotifyReset)
+            ResetEvent( cq->notify.u.Event.EventHandle );
+
+        /* arm first, so that a request completing after the check signals the notification */
+        InterlockedExchange( &cq->notify_armed, 1 );
+        if (rio_cq_has_completions( cq ) && InterlockedExchange( &cq->notify_armed, 0 ))
+            rio_signal( cq );
+    }
+    LeaveCriticalSection( &cq->cs );
+    return ret;
+}
+
+static RIO_BUFFERID WINAPI WS2_RIORegisterBuffer( PCHAR data, DWORD size )
+{
+    struct rio_buffer *buffer;
+
+    TRACE( "data %p, size %u\n", data, size );
+
+    if (!data || !size)
+    {
+        SetLastError( WSAEINVAL );
+        return RIO_INVALID_BUFFERID;
+    }
+    if (!(buffer = HeapAlloc( GetProcessHeap(), 0, sizeof(*buffer) )))
+    {
+        SetLastError( WSAENOBUFS );
+        return RIO_INVALID_BUFFERID;
+    }
+    buffer->data = data;
+    buffer->size = size;
+    return (RIO_BUFFERID)buffer;
+}
+
+static void WINAPI WS2_RIODeregisterBuffer( RIO_BUFFERID id )
+{
+    TRACE( "id %p\n", id );
+
+    if (id != RIO_INVALID_BUFFERID) HeapFree( GetProcessHeap(), 0, id );
+}
+
 /***********************************************************************
  *		getpeername		(WS2_32.5)
  */
@@ -4492,6 +5162,7 @@ static const char *debugstr_wsaioctl(DWORD code)
         IOCTL_NAME(WS_SIO_GET_GROUP_QOS);
         IOCTL_NAME(WS_SIO_GET_INTERFACE_LIST);
         /* IOCTL_NAME(WS_SIO_GET_INTERFACE_LIST_EX); */
+        IOCTL_NAME(WS_SIO_GET_MULTIPLE_EXTENSION_FUNCTION_POINTER);
         IOCTL_NAME(WS_SIO_GET_QOS);
         /* IOCTL_NAME(WS_SIO_IDEAL_SEND_BACKLOG_CHANGE);
         IOCTL_NAME(WS_SIO_IDEAL_SEND_BACKLOG_QUERY); */
@@ -4950,6 +5621,48 @@ INT WINAPI WSAIoctl(SOCKET s, DWORD code, LPVOID in_buff, DWORD in_size, LPVOID
         status = WSAEOPNOTSUPP;
         break;
     }
+    case WS_SIO_GET_MULTIPLE_EXTENSION_FUNCTION_POINTER:
+    {
+        static const GUID rio_guid = WSAID_MULTIPLE_RIO;
+        static const RIO_EXTENSION_FUNCTION_TABLE rio_table =
+        {
+            sizeof(RIO_EXTENSION_FUNCTION_TABLE),
+            WS2_RIOReceive,
+            WS2_RIOReceiveEx,
+            WS2_RIOSend,
+            WS2_RIOSendEx,
+            WS2_RIOCloseCompletionQueue,
+            WS2_RIOCreateCompletionQueue,
+            WS2_RIOCreateRequestQueue,
+            WS2_RIODequeueCompletion,
+            WS2_RIODeregisterBuffer,
+            WS2_RIONotify,
+            WS2_RIORegisterBuffer,
+            WS2_RIOResizeCompletionQueue,
+            WS2_RIOResizeRequestQueue
+        };
+
+        if (!in_buff || in_size < sizeof(GUID) || !out_buff)
+        {
+            status = WSAEFAULT;
+            break;
+        }
+        if (!IsEqualGUID(&rio_guid, in_buff))
+        {
+            FIXME("SIO_GET_MULTIPLE_EXTENSION_FUNCTION_POINTER %s: stub\n", debugstr_guid(in_buff));
+            status = WSAEOPNOTSUPP;
+            break;
+        }
+        if (out_size < sizeof(rio_table))
+        {
+            status = WSAEFAULT;
+            break;
+        }
+        TRACE("-> got RIO function table\n");
+        memcpy(out_buff, &rio_table, sizeof(rio_table));
+        total = sizeof(rio_table);
+        break;
+    }
     case WS_SIO_KEEPALIVE_VALS:
     {
         struct tcp_keepalive *k;
@@ -5640,8 +6353,8 @@ static int WS2_sendto( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
             return SOCKET_ERROR;
         }
 
-        iosb->u.Status = STATUS_SUCCESS;
         iosb->Information = n;
+        iosb->u.Status = STATUS_SUCCESS;
         if (lpNumberOfBytesSent) *lpNumberOfBytesSent = n;
         if (!wsa->completion_func)
         {
@@ -8055,8 +8768,8 @@ static int WS2_recv_base( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
                 return SOCKET_ERROR;
             }
 
-            iosb->u.Status = STATUS_SUCCESS;
             iosb->Information = n;
+            iosb->u.Status = STATUS_SUCCESS;
             if (!wsa->completion_func)
             {
                 if (cvalue) WS_AddCompletion( s, cvalue, STATUS_SUCCESS, n, FALSE );
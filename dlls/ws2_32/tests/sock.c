@@ -11447,6 +11447,122 @@ static void iocp_async_read_thread(SOCKET src, SOCKET dst)
     DestroyWindow(hwnd);
 }
 
+static void test_RIO(void)
+{
+    GUID rio_guid = WSAID_MULTIPLE_RIO;
+    RIO_EXTENSION_FUNCTION_TABLE rio;
+    RIO_NOTIFICATION_COMPLETION notify;
+    RIO_BUFFERID buffer_id;
+    RIO_CQ cq;
+    RIO_RQ rq;
+    RIO_BUF buf;
+    RIORESULT result;
+    struct sockaddr_in addr;
+    char buffer[64], data[16];
+    SOCKET s, dst;
+    int len, ret;
+    HANDLE event;
+    DWORD size;
+    ULONG count;
+
+    s = WSASocketW(AF_INET, SOCK_DGRAM, IPPROTO_UDP, NULL, 0, WSA_FLAG_REGISTERED_IO);
+    ok(s != INVALID_SOCKET, "WSASocketW failed, error %d\n", WSAGetLastError());
+
+    memset(&rio, 0, sizeof(rio));
+    ret = WSAIoctl(s, SIO_GET_MULTIPLE_EXTENSION_FUNCTION_POINTER, &rio_guid, sizeof(rio_guid),
+                   &rio, sizeof(rio), &size, NULL, NULL);
+    if (ret)
+    {
+        win_skip("RIO not supported\n");
+        closesocket(s);
+        return;
+    }
+    ok(size == sizeof(rio), "got size %u\n", size);
+    ok(rio.cbSize == sizeof(rio), "got cbSize %u\n", rio.cbSize);
+
+    dst = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ok(dst != INVALID_SOCKET, "socket failed, error %d\n", WSAGetLastError());
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    ret = bind(dst, (struct sockaddr *)&addr, sizeof(addr));
+    ok(!ret, "bind failed, error %d\n", WSAGetLastError());
+    ret = bind(s, (struct sockaddr *)&addr, sizeof(addr));
+    ok(!ret, "bind failed, error %d\n", WSAGetLastError());
+
+    buffer_id = rio.RIORegisterBuffer(buffer, sizeof(buffer));
+    ok(buffer_id != RIO_INVALID_BUFFERID, "RIORegisterBuffer failed, error %d\n", WSAGetLastError());
+
+    event = CreateEventW(NULL, FALSE, FALSE, NULL);
+    notify.Type = RIO_EVENT_COMPLETION;
+    notify.Event.EventHandle = event;
+    notify.Event.NotifyReset = FALSE;
+    cq = rio.RIOCreateCompletionQueue(8, &notify);
+    ok(cq != RIO_INVALID_CQ, "RIOCreateCompletionQueue failed, error %d\n", WSAGetLastError());
+
+    rq = rio.RIOCreateRequestQueue(s, 1, 1, 1, 1, cq, cq, (void *)0xdead);
+    ok(rq != RIO_INVALID_RQ, "RIOCreateRequestQueue failed, error %d\n", WSAGetLastError());
+
+    buf.BufferId = buffer_id;
+    buf.Offset = 0;
+    buf.Length = sizeof(buffer);
+    ret = rio.RIOReceive(rq, &buf, 1, 0, (void *)0xbeef);
+    ok(ret, "RIOReceive failed, error %d\n", WSAGetLastError());
+
+    count = rio.RIODequeueCompletion(cq, &result, 1);
+    ok(!count, "got %u completions\n", count);
+
+    ret = rio.RIONotify(cq);
+    ok(!ret, "RIONotify failed, error %d\n", ret);
+
+    len = sizeof(addr);
+    ret = getsockname(s, (struct sockaddr *)&addr, &len);
+    ok(!ret, "getsockname failed, error %d\n", WSAGetLastError());
+    ret = sendto(dst, "hello", 5, 0, (struct sockaddr *)&addr, sizeof(addr));
+    ok(ret == 5, "sendto returned %d, error %d\n", ret, WSAGetLastError());
+
+    ret = WaitForSingleObject(event, 1000);
+    ok(!ret, "wait returned %d\n", ret);
+
+    memset(&result, 0xcc, sizeof(result));
+    count = rio.RIODequeueCompletion(cq, &result, 1);
+    ok(count == 1, "got %u completions\n", count);
+    ok(!result.Status, "got status %d\n", result.Status);
+    ok(result.BytesTransferred == 5, "got %u bytes\n", result.BytesTransferred);
+    ok(result.SocketContext == 0xdead, "got socket context %s\n", wine_dbgstr_longlong(result.SocketContext));
+    ok(result.RequestContext == 0xbeef, "got request context %s\n", wine_dbgstr_longlong(result.RequestContext));
+    ok(!memcmp(buffer, "hello", 5), "got data %.5s\n", buffer);
+
+    len = sizeof(addr);
+    ret = getsockname(dst, (struct sockaddr *)&addr, &len);
+    ok(!ret, "getsockname failed, error %d\n", WSAGetLastError());
+    ret = connect(s, (struct sockaddr *)&addr, sizeof(addr));
+    ok(!ret, "connect failed, error %d\n", WSAGetLastError());
+
+    memcpy(buffer, "world", 5);
+    buf.Length = 5;
+    ret = rio.RIOSend(rq, &buf, 1, 0, (void *)0xf00d);
+    ok(ret, "RIOSend failed, error %d\n", WSAGetLastError());
+
+    ret = recv(dst, data, sizeof(data), 0);
+    ok(ret == 5, "recv returned %d, error %d\n", ret, WSAGetLastError());
+    ok(!memcmp(data, "world", 5), "got data %.5s\n", data);
+
+    memset(&result, 0xcc, sizeof(result));
+    count = rio.RIODequeueCompletion(cq, &result, 1);
+    ok(count == 1, "got %u completions\n", count);
+    ok(!result.Status, "got status %d\n", result.Status);
+    ok(result.BytesTransferred == 5, "got %u bytes\n", result.BytesTransferred);
+    ok(result.RequestContext == 0xf00d, "got request context %s\n", wine_dbgstr_longlong(result.RequestContext));
+
+    closesocket(s);
+    closesocket(dst);
+    rio.RIOCloseCompletionQueue(cq);
+    rio.RIODeregisterBuffer(buffer_id);
+    CloseHandle(event);
+}
+
 static void test_iocp(void)
 {
     SOCKET src, dst;
@@ -11542,6 +11658,7 @@ START_TEST( sock )
     test_WSAPoll();
     test_write_watch();
     test_iocp();
+    test_RIO();
 
     test_events(0);
     test_events(1);
@@ -370,6 +370,16 @@ typedef struct
     int          high_part;
 } luid_t;
 
+
+typedef struct
+{
+    apc_param_t   ckey;
+    apc_param_t   cvalue;
+    apc_param_t   information;
+    unsigned int  status;
+    unsigned int  __pad;
+} completion_msg_t;
+
 #define MAX_ACL_LEN 65535
 
 struct security_descriptor
@@ -5344,6 +5354,19 @@ struct remove_completion_reply
 
 
 
+struct remove_completions_request
+{
+    struct request_header __header;
+    obj_handle_t handle;
+};
+struct remove_completions_reply
+{
+    struct reply_header __header;
+    /* VARARG(msgs,completion_msgs); */
+};
+
+
+
 struct query_completion_request
 {
     struct request_header __header;
@@ -5936,6 +5959,7 @@ enum request
     REQ_open_completion,
     REQ_add_completion,
     REQ_remove_completion,
+    REQ_remove_completions,
     REQ_query_completion,
     REQ_set_completion_info,
     REQ_add_fd_completion,
@@ -6234,6 +6258,7 @@ union generic_request
     struct open_completion_request open_completion_request;
     struct add_completion_request add_completion_request;
     struct remove_completion_request remove_completion_request;
+    struct remove_completions_request remove_completions_request;
     struct query_completion_request query_completion_request;
     struct set_completion_info_request set_completion_info_request;
     struct add_fd_completion_request add_fd_completion_request;
@@ -6530,6 +6555,7 @@ union generic_reply
     struct open_completion_reply open_completion_reply;
     struct add_completion_reply add_completion_reply;
     struct remove_completion_reply remove_completion_reply;
+    struct remove_completions_reply remove_completions_reply;
     struct query_completion_reply query_completion_reply;
     struct set_completion_info_reply set_completion_info_reply;
     struct add_fd_completion_reply add_fd_completion_reply;
@@ -6553,6 +6579,6 @@ union generic_reply
     struct terminate_job_reply terminate_job_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 571
+#define SERVER_PROTOCOL_VERSION 572
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
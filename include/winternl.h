@@ -1682,6 +1682,18 @@ typedef struct _DEBUG_HEAP_INFORMATION {
   PVOID  Blocks;
 } DEBUG_HEAP_INFORMATION, *PDEBUG_HEAP_INFORMATION;
 
+typedef struct _RTL_HEAP_USAGE {
+  ULONG     Length;
+  SIZE_T    BytesAllocated;
+  SIZE_T    BytesCommitted;
+  SIZE_T    BytesReserved;
+  SIZE_T    BytesReservedMaximum;
+  PVOID     Entries;
+  PVOID     AddedEntries;
+  PVOID     RemovedEntries;
+  ULONG_PTR Reserved[8];
+} RTL_HEAP_USAGE, *PRTL_HEAP_USAGE;
+
 typedef struct _DEBUG_LOCK_INFORMATION {
   PVOID  Address;
   USHORT Type;
@@ -2859,6 +2871,7 @@ NTSYSAPI NTSTATUS  WINAPI RtlUpcaseUnicodeToOemN(LPSTR,DWORD,LPDWORD,LPCWSTR,DWO
 NTSYSAPI NTSTATUS  WINAPI RtlUpdateTimer(HANDLE, HANDLE, DWORD, DWORD);
 NTSYSAPI CHAR      WINAPI RtlUpperChar(CHAR);
 NTSYSAPI void      WINAPI RtlUpperString(STRING *,const STRING *);
+NTSYSAPI NTSTATUS  WINAPI RtlUsageHeap(HANDLE,ULONG,PRTL_HEAP_USAGE);
 NTSYSAPI NTSTATUS  WINAPI RtlValidSecurityDescriptor(PSECURITY_DESCRIPTOR);
 NTSYSAPI BOOLEAN   WINAPI RtlValidRelativeSecurityDescriptor(PSECURITY_DESCRIPTOR,ULONG,SECURITY_INFORMATION);
 NTSYSAPI BOOLEAN   WINAPI RtlValidAcl(PACL);
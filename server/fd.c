@@ -104,6 +104,7 @@
 
 #include "winternl.h"
 #include "winioctl.h"
+#include "wine/rbtree.h"
 
 #if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_EPOLL_CREATE)
 # include <sys/epoll.h>
@@ -359,13 +360,25 @@ static file_pos_t max_unix_offset = OFF_T_MAX;
 
 struct timeout_user
 {
-    struct list           entry;      /* entry in sorted timeout list */
+    struct wine_rb_entry  entry;      /* entry in timeouts tree, sorted by expiry time */
+    struct list           expired;    /* entry in expired timeouts list */
     timeout_t             when;       /* timeout expiry (absolute time) */
     timeout_callback      callback;   /* callback function */
     void                 *private;    /* callback private data */
 };
 
-static struct list timeout_list = LIST_INIT(timeout_list);   /* sorted timeouts list */
+static int compare_timeout( const void *key, const struct wine_rb_entry *entry )
+{
+    const struct timeout_user *user = key;
+    const struct timeout_user *timeout = WINE_RB_ENTRY_VALUE( entry, const struct timeout_user, entry );
+
+    if (user->when != timeout->when) return (user->when < timeout->when) ? -1 : 1;
+    /* keep timeouts with the same expiry time distinct */
+    if (user != timeout) return (user < timeout) ? -1 : 1;
+    return 0;
+}
+
+static struct wine_rb_tree timeout_tree = { compare_timeout };   /* timeouts sorted by expiry time */
 timeout_t current_time;
 
 static inline void set_current_time(void)
@@ -380,28 +393,22 @@ static inline void set_current_time(void)
 struct timeout_user *add_timeout_user( timeout_t when, timeout_callback func, void *private )
 {
     struct timeout_user *user;
-    struct list *ptr;
 
     if (!(user = mem_alloc( sizeof(*user) ))) return NULL;
     user->when     = (when > 0) ? when : current_time - when;
     user->callback = func;
     user->private  = private;
+    list_init( &user->expired );  /* not expired yet */
 
-    /* Now insert it in the linked list */
-
-    LIST_FOR_EACH( ptr, &timeout_list )
-    {
-        struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-        if (timeout->when >= user->when) break;
-    }
-    list_add_before( ptr, &user->entry );
+    wine_rb_put( &timeout_tree, user, &user->entry );
     return user;
 }
 
 /* remove a timeout user */
 void remove_timeout_user( struct timeout_user *user )
 {
-    list_remove( &user->entry );
+    if (!list_empty( &user->expired )) list_remove( &user->expired );
+    else wine_rb_remove( &timeout_tree, &user->entry );
     free( user );
 }
 
@@ -847,38 +854,37 @@ static void remove_poll_user( struct fd *fd, int user )
 /* process pending timeouts and return the time until the next timeout, in milliseconds */
 static int get_next_timeout(void)
 {
-    if (!list_empty( &timeout_list ))
+    struct wine_rb_entry *ptr;
+
+    if (timeout_tree.root)
     {
-        struct list expired_list, *ptr;
+        struct list expired_list, *entry;
 
-        /* first remove all expired timers from the list */
+        /* first remove all expired timers from the tree */
 
         list_init( &expired_list );
-        while ((ptr = list_head( &timeout_list )) != NULL)
+        while ((ptr = wine_rb_head( timeout_tree.root )) != NULL)
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
+            struct timeout_user *timeout = WINE_RB_ENTRY_VALUE( ptr, struct timeout_user, entry );
 
-            if (timeout->when <= current_time)
-            {
-                list_remove( &timeout->entry );
-                list_add_tail( &expired_list, &timeout->entry );
-            }
-            else break;
+            if (timeout->when > current_time) break;
+            wine_rb_remove( &timeout_tree, &timeout->entry );
+            list_add_tail( &expired_list, &timeout->expired );
         }
 
         /* now call the callback for all the removed timers */
 
-        while ((ptr = list_head( &expired_list )) != NULL)
+        while ((entry = list_head( &expired_list )) != NULL)
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-            list_remove( &timeout->entry );
+            struct timeout_user *timeout = LIST_ENTRY( entry, struct timeout_user, expired );
+            list_remove( &timeout->expired );
             timeout->callback( timeout->private );
             free( timeout );
         }
 
-        if ((ptr = list_head( &timeout_list )) != NULL)
+        if ((ptr = wine_rb_head( timeout_tree.root )) != NULL)
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
+            struct timeout_user *timeout = WINE_RB_ENTRY_VALUE( ptr, struct timeout_user, entry );
             int diff = (timeout->when - current_time + 9999) / 10000;
             if (diff < 0) diff = 0;
             return diff;
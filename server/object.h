@@ -244,6 +244,7 @@ extern struct object *create_obj_symlink( struct object *root, const struct unic
   /* command-line options */
 extern int debug_level;
 extern int foreground;
+extern int request_stats;
 extern timeout_t master_socket_timeout;
 extern const char *server_argv0;
 
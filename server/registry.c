@@ -60,6 +60,14 @@ struct notify
     struct process   *process;  /* process in which the hkey is valid */
 };
 
+/* hash index of the subkey or value names of a large key */
+struct name_index
+{
+    unsigned int      size;        /* number of hash buckets, a power of 2 */
+    int              *buckets;     /* first array entry in each bucket, or -1 */
+    int              *next;        /* next array entry in the same bucket, or -1 */
+};
+
 /* a registry key */
 struct key
 {
@@ -72,9 +80,13 @@ struct key
     int               last_subkey; /* last in use subkey */
     int               nb_subkeys;  /* count of allocated subkeys */
     struct key      **subkeys;     /* subkeys array */
+    int               sorted_subkeys; /* count of subkeys in sorted order at the start of the array */
+    struct name_index *subkey_index; /* hash index of the subkeys, if there are many */
     int               last_value;  /* last in use value */
     int               nb_values;   /* count of allocated values in array */
     struct key_value *values;      /* values array */
+    int               sorted_values; /* count of values in sorted order at the start of the array */
+    struct name_index *value_index; /* hash index of the values, if there are many */
     unsigned int      flags;       /* flags */
     timeout_t         modif;       /* last modification time */
     struct list       notify_list; /* list of notifications */
@@ -100,6 +112,7 @@ struct key_value
 
 #define MIN_SUBKEYS  8   /* min. number of allocated subkeys per key */
 #define MIN_VALUES   8   /* min. number of allocated values per key */
+#define MIN_INDEXED  256 /* min. number of subkeys or values of a key to index them */
 
 #define MAX_NAME_LEN  256    /* max. length of a key name */
 #define MAX_VALUE_LEN 16383  /* max. length of a value name */
@@ -118,6 +131,9 @@ static const WCHAR symlink_value[] = {'S','y','m','b','o','l','i','c','L','i','n
 static const struct unicode_str symlink_str = { symlink_value, sizeof(symlink_value) };
 
 static void set_periodic_save_timer(void);
+static void free_name_index( struct name_index *index );
+static void sort_subkeys( struct key *key );
+static void sort_values( struct key *key );
 static struct key_value *find_value( const struct key *key, const struct unicode_str *name, int *index );
 
 /* information about where to save a registry branch */
@@ -132,6 +148,16 @@ static int save_branch_count;
 static struct save_branch_info save_branch_info[MAX_SAVE_BRANCH_INFO];
 
 
+#define MAX_LOAD_PATH_DEPTH 32  /* max. number of path elements remembered while loading */
+
+/* a path element of the last key loaded from a file */
+struct load_path_elem
+{
+    data_size_t  pos;     /* position of the element in the path buffer, in chars */
+    data_size_t  len;     /* length of the element in bytes */
+    struct key  *key;     /* corresponding key */
+};
+
 /* information about a file being loaded */
 struct file_load_info
 {
@@ -142,6 +168,10 @@ struct file_load_info
     int         line;     /* current input line */
     WCHAR      *tmp;      /* temp buffer to use while parsing input */
     size_t      tmplen;   /* length of temp buffer */
+    WCHAR      *path;     /* name of the last loaded key */
+    size_t      pathlen;  /* length of path buffer */
+    unsigned int depth;   /* number of valid elements in path_elems */
+    struct load_path_elem path_elems[MAX_LOAD_PATH_DEPTH];
 };
 
 
@@ -256,11 +286,13 @@ static void dump_value( const struct key_value *value, FILE *f )
 }
 
 /* save a registry and all its subkeys to a text file */
-static void save_subkeys( const struct key *key, const struct key *base, FILE *f )
+static void save_subkeys( struct key *key, const struct key *base, FILE *f )
 {
     int i;
 
     if (key->flags & KEY_VOLATILE) return;
+    sort_subkeys( key );
+    sort_values( key );
     /* save key if it has either some values or no subkeys, or needs special options */
     /* keys with no values but subkeys are saved implicitly by saving the subkeys */
     if ((key->last_value >= 0) || (key->last_subkey == -1) || key->class || (key->flags & KEY_SYMLINK))
@@ -418,12 +450,14 @@ static void key_destroy( struct object *obj )
         free( key->values[i].data );
     }
     free( key->values );
+    free_name_index( key->value_index );
     for (i = 0; i <= key->last_subkey; i++)
     {
         key->subkeys[i]->parent = NULL;
         release_object( key->subkeys[i] );
     }
     free( key->subkeys );
+    free_name_index( key->subkey_index );
     /* unconditionally notify everything waiting on this key */
     while ((ptr = list_head( &key->notify_list )))
     {
@@ -487,9 +521,13 @@ static struct key *alloc_key( const struct unicode_str *name, timeout_t modif )
         key->last_subkey = -1;
         key->nb_subkeys  = 0;
         key->subkeys     = NULL;
+        key->sorted_subkeys = 0;
+        key->subkey_index = NULL;
         key->nb_values   = 0;
         key->last_value  = -1;
         key->values      = NULL;
+        key->sorted_values = 0;
+        key->value_index = NULL;
         key->modif       = modif;
         key->parent      = NULL;
         list_init( &key->notify_list );
@@ -551,6 +589,150 @@ static void touch_key( struct key *key, unsigned int change )
         check_notify( k, change, 0 );
 }
 
+/* compare two key or value names, case-insensitively */
+static int compare_names( const WCHAR *name1, data_size_t len1, const WCHAR *name2, data_size_t len2 )
+{
+    int res = memicmpW( name1, name2, min( len1, len2 ) / sizeof(WCHAR) );
+    if (!res) res = len1 - len2;
+    return res;
+}
+
+static int compare_subkeys( const void *p1, const void *p2 )
+{
+    const struct key *key1 = *(const struct key * const *)p1;
+    const struct key *key2 = *(const struct key * const *)p2;
+    return compare_names( key1->name, key1->namelen, key2->name, key2->namelen );
+}
+
+static int compare_values( const void *p1, const void *p2 )
+{
+    const struct key_value *value1 = p1;
+    const struct key_value *value2 = p2;
+    return compare_names( value1->name, value1->namelen, value2->name, value2->namelen );
+}
+
+/* merge the unsorted entries at the end of an array into the sorted ones before them */
+static void merge_sorted( void *base, int sorted, int count, size_t size,
+                          int (*compare)(const void *, const void *) )
+{
+    char *array = base, *tail;
+    int i, j, k;
+
+    if (sorted == count) return;
+    qsort( array + sorted * size, count - sorted, size, compare );
+    if (!sorted || compare( array + (sorted - 1) * size, array + sorted * size ) < 0) return;
+    if (!(tail = malloc( (count - sorted) * size )))
+    {
+        qsort( array, count, size, compare );
+        return;
+    }
+    memcpy( tail, array + sorted * size, (count - sorted) * size );
+    /* merge backwards, starting with the largest entries */
+    i = sorted - 1;
+    j = count - sorted - 1;
+    for (k = count - 1; j >= 0; k--)
+    {
+        if (i >= 0 && compare( array + i * size, tail + j * size ) > 0)
+            memcpy( array + k * size, array + i-- * size, size );
+        else
+            memcpy( array + k * size, tail + j-- * size, size );
+    }
+    free( tail );
+}
+
+/* hash a key or value name, case-insensitively */
+static unsigned int hash_name( const WCHAR *name, data_size_t len )
+{
+    unsigned int i, hash = 0;
+
+    for (i = 0; i < len / sizeof(WCHAR); i++) hash = hash * 31 + tolowerW( name[i] );
+    return hash;
+}
+
+/* allocate an empty name index for an array of the given size */
+static struct name_index *alloc_name_index( int array_size )
+{
+    struct name_index *index;
+    unsigned int i;
+
+    if (!(index = malloc( sizeof(*index) ))) return NULL;
+    for (index->size = MIN_INDEXED; index->size < array_size; index->size *= 2) ;
+    index->buckets = malloc( index->size * sizeof(*index->buckets) );
+    index->next = malloc( array_size * sizeof(*index->next) );
+    if (!index->buckets || !index->next)
+    {
+        free( index->buckets );
+        free( index->next );
+        free( index );
+        return NULL;
+    }
+    for (i = 0; i < index->size; i++) index->buckets[i] = -1;
+    return index;
+}
+
+static void free_name_index( struct name_index *index )
+{
+    if (!index) return;
+    free( index->buckets );
+    free( index->next );
+    free( index );
+}
+
+/* add an array entry to a name index */
+static void name_index_add( struct name_index *index, int pos, const WCHAR *name, data_size_t len )
+{
+    unsigned int bucket = hash_name( name, len ) & (index->size - 1);
+
+    index->next[pos] = index->buckets[bucket];
+    index->buckets[bucket] = pos;
+}
+
+/* remove an array entry from a name index, and renumber the entries that follow it */
+static void name_index_remove( struct name_index *index, int pos, int count,
+                               const WCHAR *name, data_size_t len )
+{
+    unsigned int i, bucket = hash_name( name, len ) & (index->size - 1);
+    int *prev = &index->buckets[bucket];
+
+    while (*prev != pos) prev = &index->next[*prev];
+    *prev = index->next[pos];
+    if (pos == count - 1) return;
+
+    memmove( &index->next[pos], &index->next[pos + 1], (count - pos - 1) * sizeof(*index->next) );
+    for (i = 0; i < index->size; i++) if (index->buckets[i] > pos) index->buckets[i]--;
+    for (i = 0; i < count - 1; i++) if (index->next[i] > pos) index->next[i]--;
+}
+
+/* (re)build the hash index of the subkeys of a key; return 1 if OK, 0 on error */
+static int index_subkeys( struct key *key )
+{
+    struct name_index *index;
+    int i;
+
+    if (!(index = alloc_name_index( key->nb_subkeys ))) return 0;
+    for (i = 0; i <= key->last_subkey; i++)
+        name_index_add( index, i, key->subkeys[i]->name, key->subkeys[i]->namelen );
+    free_name_index( key->subkey_index );
+    key->subkey_index = index;
+    return 1;
+}
+
+/* sort the subkeys of a key, which may have been appended unsorted to an indexed key */
+static void sort_subkeys( struct key *key )
+{
+    int count = key->last_subkey + 1;
+
+    if (key->sorted_subkeys == count) return;
+    merge_sorted( key->subkeys, key->sorted_subkeys, count, sizeof(*key->subkeys), compare_subkeys );
+    key->sorted_subkeys = count;
+    if (!index_subkeys( key ))
+    {
+        /* lookups don't need an index in a sorted array */
+        free_name_index( key->subkey_index );
+        key->subkey_index = NULL;
+    }
+}
+
 /* try to grow the array of subkeys; return 1 if OK, 0 on error */
 static int grow_subkeys( struct key *key )
 {
@@ -573,6 +755,11 @@ static int grow_subkeys( struct key *key )
     }
     key->subkeys    = new_subkeys;
     key->nb_subkeys = nb_subkeys;
+    if (key->subkey_index && !index_subkeys( key ))
+    {
+        set_error( STATUS_NO_MEMORY );
+        return 0;
+    }
     return 1;
 }
 
@@ -581,7 +768,6 @@ static struct key *alloc_subkey( struct key *parent, const struct unicode_str *n
                                  int index, timeout_t modif )
 {
     struct key *key;
-    int i;
 
     if (name->len > MAX_NAME_LEN * sizeof(WCHAR))
     {
@@ -596,9 +782,18 @@ static struct key *alloc_subkey( struct key *parent, const struct unicode_str *n
     if ((key = alloc_key( name, modif )) != NULL)
     {
         key->parent = parent;
-        for (i = ++parent->last_subkey; i > index; i--)
-            parent->subkeys[i] = parent->subkeys[i-1];
+        memmove( &parent->subkeys[index + 1], &parent->subkeys[index],
+                 (++parent->last_subkey - index) * sizeof(*parent->subkeys) );
         parent->subkeys[index] = key;
+        if (parent->subkey_index)
+        {
+            /* new subkeys are appended to an indexed key; they remain sorted if added in order */
+            if (parent->sorted_subkeys == index &&
+                (!index || compare_subkeys( &parent->subkeys[index - 1], &key ) < 0))
+                parent->sorted_subkeys++;
+            name_index_add( parent->subkey_index, index, key->name, key->namelen );
+        }
+        else if (++parent->sorted_subkeys >= MIN_INDEXED) index_subkeys( parent );
         if (is_wow6432node( key->name, key->namelen ) && !is_wow6432node( parent->name, parent->namelen ))
             parent->flags |= KEY_WOW64;
     }
@@ -609,14 +804,18 @@ static struct key *alloc_subkey( struct key *parent, const struct unicode_str *n
 static void free_subkey( struct key *parent, int index )
 {
     struct key *key;
-    int i, nb_subkeys;
+    int nb_subkeys;
 
     assert( index >= 0 );
     assert( index <= parent->last_subkey );
 
     key = parent->subkeys[index];
-    for (i = index; i < parent->last_subkey; i++) parent->subkeys[i] = parent->subkeys[i + 1];
+    if (parent->subkey_index)
+        name_index_remove( parent->subkey_index, index, parent->last_subkey + 1, key->name, key->namelen );
+    memmove( &parent->subkeys[index], &parent->subkeys[index + 1],
+             (parent->last_subkey - index) * sizeof(*parent->subkeys) );
     parent->last_subkey--;
+    if (index < parent->sorted_subkeys) parent->sorted_subkeys--;
     key->flags |= KEY_DELETED;
     key->parent = NULL;
     if (is_wow6432node( key->name, key->namelen )) parent->flags &= ~KEY_WOW64;
@@ -638,17 +837,29 @@ static void free_subkey( struct key *parent, int index )
 /* find the named child of a given key and return its index */
 static struct key *find_subkey( const struct key *key, const struct unicode_str *name, int *index )
 {
+    const struct name_index *name_index = key->subkey_index;
     int i, min, max, res;
-    data_size_t len;
+
+    if (name_index)
+    {
+        for (i = name_index->buckets[hash_name( name->str, name->len ) & (name_index->size - 1)];
+             i != -1; i = name_index->next[i])
+        {
+            if (compare_names( key->subkeys[i]->name, key->subkeys[i]->namelen, name->str, name->len ))
+                continue;
+            *index = i;
+            return key->subkeys[i];
+        }
+        *index = key->last_subkey + 1;  /* new subkeys are appended to an indexed key */
+        return NULL;
+    }
 
     min = 0;
     max = key->last_subkey;
     while (min <= max)
     {
         i = (min + max) / 2;
-        len = min( key->subkeys[i]->namelen, name->len );
-        res = memicmpW( key->subkeys[i]->name, name->str, len / sizeof(WCHAR) );
-        if (!res) res = key->subkeys[i]->namelen - name->len;
+        res = compare_names( key->subkeys[i]->name, key->subkeys[i]->namelen, name->str, name->len );
         if (!res)
         {
             *index = i;
@@ -877,7 +1088,7 @@ static struct key *create_key_recursive( struct key *key, const struct unicode_s
 }
 
 /* query information about a key or a subkey */
-static void enum_key( const struct key *key, int index, int info_class,
+static void enum_key( struct key *key, int index, int info_class,
                       struct enum_key_reply *reply )
 {
     static const WCHAR backslash[] = { '\\' };
@@ -895,6 +1106,7 @@ static void enum_key( const struct key *key, int index, int info_class,
             set_error( STATUS_NO_MORE_ENTRIES );
             return;
         }
+        sort_subkeys( key );
         key = key->subkeys[index];
     }
 
@@ -1017,6 +1229,36 @@ static int delete_key( struct key *key, int recurse )
     return 0;
 }
 
+/* (re)build the hash index of the values of a key; return 1 if OK, 0 on error */
+static int index_values( struct key *key )
+{
+    struct name_index *index;
+    int i;
+
+    if (!(index = alloc_name_index( key->nb_values ))) return 0;
+    for (i = 0; i <= key->last_value; i++)
+        name_index_add( index, i, key->values[i].name, key->values[i].namelen );
+    free_name_index( key->value_index );
+    key->value_index = index;
+    return 1;
+}
+
+/* sort the values of a key, which may have been appended unsorted to an indexed key */
+static void sort_values( struct key *key )
+{
+    int count = key->last_value + 1;
+
+    if (key->sorted_values == count) return;
+    merge_sorted( key->values, key->sorted_values, count, sizeof(*key->values), compare_values );
+    key->sorted_values = count;
+    if (!index_values( key ))
+    {
+        /* lookups don't need an index in a sorted array */
+        free_name_index( key->value_index );
+        key->value_index = NULL;
+    }
+}
+
 /* try to grow the array of values; return 1 if OK, 0 on error */
 static int grow_values( struct key *key )
 {
@@ -1039,23 +1281,40 @@ static int grow_values( struct key *key )
     }
     key->values = new_val;
     key->nb_values = nb_values;
+    if (key->value_index && !index_values( key ))
+    {
+        set_error( STATUS_NO_MEMORY );
+        return 0;
+    }
     return 1;
 }
 
 /* find the named value of a given key and return its index in the array */
 static struct key_value *find_value( const struct key *key, const struct unicode_str *name, int *index )
 {
+    const struct name_index *name_index = key->value_index;
     int i, min, max, res;
-    data_size_t len;
+
+    if (name_index)
+    {
+        for (i = name_index->buckets[hash_name( name->str, name->len ) & (name_index->size - 1)];
+             i != -1; i = name_index->next[i])
+        {
+            if (compare_names( key->values[i].name, key->values[i].namelen, name->str, name->len ))
+                continue;
+            *index = i;
+            return &key->values[i];
+        }
+        *index = key->last_value + 1;  /* new values are appended to an indexed key */
+        return NULL;
+    }
 
     min = 0;
     max = key->last_value;
     while (min <= max)
     {
         i = (min + max) / 2;
-        len = min( key->values[i].namelen, name->len );
-        res = memicmpW( key->values[i].name, name->str, len / sizeof(WCHAR) );
-        if (!res) res = key->values[i].namelen - name->len;
+        res = compare_names( key->values[i].name, key->values[i].namelen, name->str, name->len );
         if (!res)
         {
             *index = i;
@@ -1073,7 +1332,6 @@ static struct key_value *insert_value( struct key *key, const struct unicode_str
 {
     struct key_value *value;
     WCHAR *new_name = NULL;
-    int i;
 
     if (name->len > MAX_VALUE_LEN * sizeof(WCHAR))
     {
@@ -1085,12 +1343,22 @@ static struct key_value *insert_value( struct key *key, const struct unicode_str
         if (!grow_values( key )) return NULL;
     }
     if (name->len && !(new_name = memdup( name->str, name->len ))) return NULL;
-    for (i = ++key->last_value; i > index; i--) key->values[i] = key->values[i - 1];
+    memmove( &key->values[index + 1], &key->values[index],
+             (++key->last_value - index) * sizeof(*key->values) );
     value = &key->values[index];
     value->name    = new_name;
     value->namelen = name->len;
     value->len     = 0;
     value->data    = NULL;
+    if (key->value_index)
+    {
+        /* new values are appended to an indexed key; they remain sorted if added in order */
+        if (key->sorted_values == index &&
+            (!index || compare_values( &key->values[index - 1], value ) < 0))
+            key->sorted_values++;
+        name_index_add( key->value_index, index, value->name, value->namelen );
+    }
+    else if (++key->sorted_values >= MIN_INDEXED) index_values( key );
     return value;
 }
 
@@ -1173,6 +1441,7 @@ static void enum_value( struct key *key, int i, int info_class, struct enum_key_
         void *data;
         data_size_t namelen, maxlen;
 
+        sort_values( key );
         value = &key->values[i];
         reply->type = value->type;
         namelen = value->namelen;
@@ -1217,7 +1486,7 @@ static void enum_value( struct key *key, int i, int info_class, struct enum_key_
 static void delete_value( struct key *key, const struct unicode_str *name )
 {
     struct key_value *value;
-    int i, index, nb_values;
+    int index, nb_values;
 
     if (!(value = find_value( key, name, &index )))
     {
@@ -1225,10 +1494,14 @@ static void delete_value( struct key *key, const struct unicode_str *name )
         return;
     }
     if (debug_level > 1) dump_operation( key, value, "Delete" );
+    if (key->value_index)
+        name_index_remove( key->value_index, index, key->last_value + 1, value->name, value->namelen );
     free( value->name );
     free( value->data );
-    for (i = index; i < key->last_value; i++) key->values[i] = key->values[i + 1];
+    memmove( &key->values[index], &key->values[index + 1],
+             (key->last_value - index) * sizeof(*key->values) );
     key->last_value--;
+    if (index < key->sorted_values) key->sorted_values--;
     touch_key( key, REG_NOTIFY_CHANGE_LAST_SET );
 
     /* try to shrink the array */
@@ -1355,6 +1628,83 @@ static int get_data_type( const char *buffer, int *type, int *parse_type )
     return 0;
 }
 
+/* create a key from the input file; similar to create_key_recursive, but since */
+/* files are saved in tree order, the keys along the path of the previously */
+/* loaded key are reused instead of being looked up again from the base key */
+static struct key *load_key_path( struct key *base, const struct unicode_str *name,
+                                  struct file_load_info *info )
+{
+    struct key *key = base, *subkey, *created = NULL;
+    struct unicode_str token;
+    unsigned int depth = 0;
+    int index, created_index = 0;
+
+    token.str = NULL;
+    if (!get_path_token( name, &token )) return NULL;
+    while (token.len && depth < info->depth)
+    {
+        struct load_path_elem *elem = &info->path_elems[depth];
+        if (elem->len != token.len ||
+            memicmpW( info->path + elem->pos, token.str, token.len / sizeof(WCHAR) )) break;
+        elem->pos = token.str - name->str;
+        key = elem->key;
+        depth++;
+        get_path_token( name, &token );
+    }
+    info->depth = 0;
+
+    while (token.len)
+    {
+        if ((subkey = find_subkey( key, &token, &index )))
+        {
+            if (!(subkey = follow_symlink( subkey, 0 )))
+            {
+                set_error( STATUS_OBJECT_NAME_NOT_FOUND );
+                return NULL;
+            }
+        }
+        else
+        {
+            if (!(subkey = alloc_subkey( key, &token, index, 0 )))
+            {
+                if (created) free_subkey( created, created_index );
+                return NULL;
+            }
+            if (!created)
+            {
+                created = key;
+                created_index = index;
+            }
+        }
+        key = subkey;
+        if (depth < MAX_LOAD_PATH_DEPTH)
+        {
+            info->path_elems[depth].pos = token.str - name->str;
+            info->path_elems[depth].len = token.len;
+            info->path_elems[depth].key = key;
+            depth++;
+        }
+        get_path_token( name, &token );
+    }
+
+    /* remember the path for the next key */
+    if (info->pathlen < name->len)
+    {
+        WCHAR *path;
+        if (!(path = realloc( info->path, name->len ))) depth = 0;
+        else
+        {
+            info->path = path;
+            info->pathlen = name->len;
+        }
+    }
+    if (depth) memcpy( info->path, name->str, name->len );
+    info->depth = depth;
+
+    grab_object( key );
+    return key;
+}
+
 /* load and create a key from the input file */
 static struct key *load_key( struct key *base, const char *buffer, int prefix_len,
                              struct file_load_info *info, timeout_t *modif )
@@ -1393,7 +1743,7 @@ static struct key *load_key( struct key *base, const char *buffer, int prefix_le
     }
     name.str = p;
     name.len = len - (p - info->tmp + 1) * sizeof(WCHAR);
-    return create_key_recursive( base, &name, 0 );
+    return load_key_path( base, &name, info );
 }
 
 /* update the modification time of a key (and its parents) after it has been loaded from a file */
@@ -1635,6 +1985,9 @@ static void load_keys( struct key *key, const char *filename, FILE *f, int prefi
     info.len    = 4;
     info.tmplen = 4;
     info.line   = 0;
+    info.path   = NULL;
+    info.pathlen = 0;
+    info.depth  = 0;
     if (!(info.buffer = mem_alloc( info.len ))) return;
     if (!(info.tmp = mem_alloc( info.tmplen )))
     {
@@ -1691,6 +2044,7 @@ static void load_keys( struct key *key, const char *filename, FILE *f, int prefi
     }
     free( info.buffer );
     free( info.tmp );
+    free( info.path );
 }
 
 /* load a part of the registry from a file */
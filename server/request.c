@@ -70,6 +70,9 @@
 #define WANT_REQUEST_HANDLERS
 #include "request.h"
 
+#define MIN_REQ_DATA_ALLOC   256    /* minimum size of the request data buffer */
+#define MAX_CACHED_REQ_DATA  65536  /* larger request buffers are freed after use */
+
 /* Some versions of glibc don't define this */
 #ifndef SCM_RIGHTS
 #define SCM_RIGHTS 1
@@ -132,6 +135,14 @@ int config_dir_fd = -1;    /* file descriptor for the config dir */
 static struct master_socket *master_socket;  /* the master socket object */
 static struct timeout_user *master_timeout;
 
+/* per-request statistics, collected with the --stats option */
+static struct request_stats
+{
+    unsigned int       count;   /* number of times the request was handled */
+    unsigned long long total;   /* total time spent in the handler, in ns */
+    unsigned long long max;     /* longest time spent in the handler, in ns */
+} req_stats[REQ_NB_REQUESTS];
+
 /* complain about a protocol error and terminate the client connection */
 void fatal_protocol_error( struct thread *thread, const char *err, ... )
 {
@@ -292,6 +303,64 @@ static void send_reply( union generic_reply *reply )
         fatal_protocol_error( current, "reply write: %s\n", strerror( errno ));
 }
 
+/* get a high resolution time stamp for the request statistics, in ns */
+static unsigned long long get_stats_time(void)
+{
+#ifdef __APPLE__
+    static mach_timebase_info_data_t timebase;
+
+    if (!timebase.denom) mach_timebase_info( &timebase );
+    return mach_absolute_time() * timebase.numer / timebase.denom;
+#else
+    struct timeval now;
+#ifdef HAVE_CLOCK_GETTIME
+    struct timespec ts;
+
+    if (!clock_gettime( CLOCK_MONOTONIC, &ts ))
+        return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+    gettimeofday( &now, NULL );
+    return now.tv_sec * 1000000000ull + now.tv_usec * 1000;
+#endif
+}
+
+static int compare_request_stats( const void *p1, const void *p2 )
+{
+    const struct request_stats *stats1 = &req_stats[*(const enum request *)p1];
+    const struct request_stats *stats2 = &req_stats[*(const enum request *)p2];
+
+    if (stats1->total == stats2->total) return 0;
+    return stats1->total < stats2->total ? 1 : -1;
+}
+
+/* print the request statistics, sorted by total time spent in the handler */
+void dump_request_stats(void)
+{
+    enum request order[REQ_NB_REQUESTS];
+    unsigned long long total = 0;
+    unsigned int i;
+
+    for (i = 0; i < REQ_NB_REQUESTS; i++)
+    {
+        order[i] = i;
+        total += req_stats[i].total;
+    }
+    qsort( order, REQ_NB_REQUESTS, sizeof(order[0]), compare_request_stats );
+
+    fprintf( stderr, "wineserver: request statistics (total %llu us)\n", total / 1000 );
+    fprintf( stderr, "%-32s %10s %12s %8s %8s %6s\n",
+             "request", "count", "total (us)", "avg (ns)", "max (us)", "%" );
+    for (i = 0; i < REQ_NB_REQUESTS; i++)
+    {
+        const struct request_stats *stats = &req_stats[order[i]];
+
+        if (!stats->count) break;
+        fprintf( stderr, "%-32s %10u %12llu %8llu %8llu %6.2f\n", get_request_name( order[i] ),
+                 stats->count, stats->total / 1000, stats->total / stats->count, stats->max / 1000,
+                 total ? stats->total * 100.0 / total : 0.0 );
+    }
+}
+
 /* call a request handler */
 static void call_req_handler( struct thread *thread )
 {
@@ -306,7 +375,19 @@ static void call_req_handler( struct thread *thread )
     if (debug_level) trace_request();
 
     if (req < REQ_NB_REQUESTS)
-        req_handlers[req]( &current->req, &reply );
+    {
+        if (request_stats)
+        {
+            unsigned long long start = get_stats_time(), time;
+
+            req_handlers[req]( &current->req, &reply );
+            time = get_stats_time() - start;
+            req_stats[req].count++;
+            req_stats[req].total += time;
+            if (time > req_stats[req].max) req_stats[req].max = time;
+        }
+        else req_handlers[req]( &current->req, &reply );
+    }
     else
         set_error( STATUS_NOT_IMPLEMENTED );
 
@@ -328,6 +409,16 @@ static void call_req_handler( struct thread *thread )
     current = NULL;
 }
 
+/* release the request data buffer once the request has been handled */
+static void release_req_data( struct thread *thread )
+{
+    /* small buffers are kept around for the next request */
+    if (thread->req_data_alloc <= MAX_CACHED_REQ_DATA) return;
+    free( thread->req_data );
+    thread->req_data = NULL;
+    thread->req_data_alloc = 0;
+}
+
 /* read a request from a thread */
 void read_request( struct thread *thread )
 {
@@ -335,23 +426,49 @@ void read_request( struct thread *thread )
 
     if (!thread->req_toread)  /* no pending request */
     {
-        if ((ret = read( get_unix_fd( thread->request_fd ), &thread->req,
-                         sizeof(thread->req) )) != sizeof(thread->req)) goto error;
+        struct iovec vec[2];
+
+        /* read the variable sized data along with the request if it fits in the buffer */
+        vec[0].iov_base = &thread->req;
+        vec[0].iov_len  = sizeof(thread->req);
+        vec[1].iov_base = thread->req_data;
+        vec[1].iov_len  = thread->req_data_alloc;
+
+        if ((ret = readv( get_unix_fd( thread->request_fd ), vec,
+                          thread->req_data_alloc ? 2 : 1 )) < (int)sizeof(thread->req)) goto error;
+        ret -= sizeof(thread->req);
+
         if (!(thread->req_toread = thread->req.request_header.request_size))
         {
             /* no data, handle request at once */
+            if (ret) goto error;
             call_req_handler( thread );
             return;
         }
-        if (!(thread->req_data = malloc( thread->req_toread )))
+        if (ret > thread->req_toread) goto error;
+        if (thread->req_toread > thread->req_data_alloc)
+        {
+            unsigned int size = max( thread->req_toread, MIN_REQ_DATA_ALLOC );
+            void *ptr = realloc( thread->req_data, size );
+
+            if (!ptr)
+            {
+                fatal_protocol_error( thread, "no memory for %u bytes request %d\n",
+                                      thread->req_toread, thread->req.request_header.req );
+                return;
+            }
+            thread->req_data = ptr;
+            thread->req_data_alloc = size;
+        }
+        if (!(thread->req_toread -= ret))
         {
-            fatal_protocol_error( thread, "no memory for %u bytes request %d\n",
-                                  thread->req_toread, thread->req.request_header.req );
+            call_req_handler( thread );
+            release_req_data( thread );
             return;
         }
     }
 
-    /* read the variable sized data */
+    /* read the remaining variable sized data */
     for (;;)
     {
         ret = read( get_unix_fd( thread->request_fd ),
@@ -362,8 +479,7 @@ void read_request( struct thread *thread )
         if (!(thread->req_toread -= ret))
         {
             call_req_handler( thread );
-            free( thread->req_data );
-            thread->req_data = NULL;
+            release_req_data( thread );
             return;
         }
     }
@@ -680,7 +680,7 @@ static struct object *create_socket( int family, int type, int protocol, unsigne
     sock->family = family;
 
     if (!(sock->fd = create_anonymous_fd( &sock_fd_ops, sockfd, &sock->obj,
-                            (flags & WSA_FLAG_OVERLAPPED) ? 0 : FILE_SYNCHRONOUS_IO_NONALERT )))
+                            (flags & (WSA_FLAG_OVERLAPPED | WSA_FLAG_REGISTERED_IO)) ? 0 : FILE_SYNCHRONOUS_IO_NONALERT )))
     {
         release_object( sock );
         return NULL;
@@ -433,6 +433,25 @@ static void dump_varargs_uints64( const char *prefix, data_size_t size )
     remove_data( size );
 }
 
+static void dump_varargs_completion_msgs( const char *prefix, data_size_t size )
+{
+    const completion_msg_t *msg = cur_data;
+    data_size_t len = size / sizeof(*msg);
+
+    fprintf( stderr,"%s{", prefix );
+    while (len > 0)
+    {
+        dump_uint64( "{ckey=", &msg->ckey );
+        dump_uint64( ",cvalue=", &msg->cvalue );
+        dump_uint64( ",information=", &msg->information );
+        fprintf( stderr, ",status=%s}", get_status_name( msg->status ) );
+        msg++;
+        if (--len) fputc( ',', stderr );
+    }
+    fputc( '}', stderr );
+    remove_data( size );
+}
+
 static void dump_varargs_apc_result( const char *prefix, data_size_t size )
 {
     const apc_result_t *result = cur_data;
@@ -4364,6 +4383,16 @@ static void dump_remove_completion_reply( const struct remove_completion_reply *
     fprintf( stderr, ", status=%08x", req->status );
 }
 
+static void dump_remove_completions_request( const struct remove_completions_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
+static void dump_remove_completions_reply( const struct remove_completions_reply *req )
+{
+    dump_varargs_completion_msgs( " msgs=", cur_size );
+}
+
 static void dump_query_completion_request( const struct query_completion_request *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
@@ -4812,6 +4841,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_open_completion_request,
     (dump_func)dump_add_completion_request,
     (dump_func)dump_remove_completion_request,
+    (dump_func)dump_remove_completions_request,
     (dump_func)dump_query_completion_request,
     (dump_func)dump_set_completion_info_request,
     (dump_func)dump_add_fd_completion_request,
@@ -5106,6 +5136,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_open_completion_reply,
     NULL,
     (dump_func)dump_remove_completion_reply,
+    (dump_func)dump_remove_completions_reply,
     (dump_func)dump_query_completion_reply,
     NULL,
     NULL,
@@ -5400,6 +5431,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "open_completion",
     "add_completion",
     "remove_completion",
+    "remove_completions",
     "query_completion",
     "set_completion_info",
     "add_fd_completion",
@@ -5612,6 +5644,15 @@ static const char *get_status_name( unsigned int status )
     return buffer;
 }
 
+const char *get_request_name( enum request req )
+{
+    static char buffer[10];
+
+    if (req < REQ_NB_REQUESTS) return req_names[req];
+    sprintf( buffer, "%d", req );
+    return buffer;
+}
+
 void trace_request(void)
 {
     enum request req = current->req.request_header.req;